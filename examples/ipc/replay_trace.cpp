@@ -0,0 +1,133 @@
+#include <chrono>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "kota/ipc/replay_transport.h"
+#include "kota/async/async.h"
+
+namespace et = kota;
+namespace ipc = et::ipc;
+
+namespace {
+
+void print_usage() {
+    std::println(stderr,
+                 "usage: replay_trace <trace.jsonl> [--speed <factor>] -- <server> [args...]");
+    std::println(stderr, "  --speed 1     original pacing (default)");
+    std::println(stderr, "  --speed 4     four times faster");
+    std::println(stderr, "  --speed 0     as fast as possible");
+}
+
+// Hand every replayed message to the server, then close its input.
+et::task<> feed_server(ipc::ReplayTransport& replay, ipc::StreamTransport& server) {
+    while(auto message = co_await replay.read_message()) {
+        auto written = co_await server.write_message(message->view());
+        if(!written) {
+            std::println(stderr, "writing to server failed: {}", written.error().message);
+            break;
+        }
+    }
+    replay.close();
+    server.close_output();
+}
+
+// Pass everything the server writes back to the replay so responses are matched.
+et::task<> drain_server(ipc::ReplayTransport& replay, ipc::StreamTransport& server) {
+    while(auto message = co_await server.read_message()) {
+        co_await replay.write_message(message->view());
+    }
+}
+
+et::task<> wait_child(et::process child) {
+    auto status = co_await child.wait();
+    if(status && (status->status != 0 || status->term_signal != 0)) {
+        std::println(stderr,
+                     "server exited: status={} signal={}",
+                     status->status,
+                     status->term_signal);
+    }
+}
+
+void print_stats(const ipc::replay_stats& stats) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    const auto p = [&](double q) {
+        return duration_cast<microseconds>(stats.latency.percentile(q)).count();
+    };
+
+    std::println("requests      {}", stats.requests);
+    std::println("notifications {}", stats.notifications);
+    std::println("responses     {} ({} unanswered)", stats.responses, stats.unanswered);
+    std::println("bytes         {} in, {} out", stats.bytes_in, stats.bytes_out);
+    std::println("elapsed       {} ms",
+                 std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed).count());
+    std::println("throughput    {:.1f} messages/s", stats.messages_per_second());
+    std::println("latency us    p50 {}  p90 {}  p99 {}  max {}", p(0.5), p(0.9), p(0.99), p(1.0));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    std::string trace;
+    ipc::replay_options options;
+    std::vector<std::string> command;
+    for(std::size_t i = 0; i < args.size(); ++i) {
+        if(args[i] == "--") {
+            command.assign(args.begin() + static_cast<std::ptrdiff_t>(i) + 1, args.end());
+            break;
+        }
+        if(args[i] == "--speed" && i + 1 < args.size()) {
+            options.speed = std::stod(args[++i]);
+        } else if(trace.empty()) {
+            trace = args[i];
+        } else {
+            print_usage();
+            return 2;
+        }
+    }
+    if(trace.empty() || command.empty()) {
+        print_usage();
+        return 2;
+    }
+
+    et::event_loop loop;
+
+    auto replay = ipc::ReplayTransport::open(trace, options, loop);
+    if(!replay) {
+        std::println(stderr, "{}", replay.error().message);
+        return 1;
+    }
+
+    et::process::options opts;
+    opts.file = command.front();
+    opts.args = command;
+    opts.streams = {
+        et::process::stdio::pipe(true, false),
+        et::process::stdio::pipe(false, true),
+        et::process::stdio::inherit(),
+    };
+
+    auto spawned = et::process::spawn(opts, loop);
+    if(!spawned) {
+        std::println(stderr, "failed to spawn {}: {}", command.front(), spawned.error().message());
+        return 1;
+    }
+
+    ipc::StreamTransport server(std::move(spawned->stdout_pipe), std::move(spawned->stdin_pipe));
+
+    std::println(stderr, "replaying {} messages from {}", (*replay)->size(), trace);
+    loop.schedule(feed_server(**replay, server));
+    loop.schedule(drain_server(**replay, server));
+    loop.schedule(wait_child(std::move(spawned->proc)));
+    loop.run();
+
+    print_stats((*replay)->stats());
+    return 0;
+}
@@ -45,7 +45,7 @@ public:
         }
     }
 
-    et::task<std::optional<std::string>> read_message() override {
+    et::task<std::optional<ipc::MessageBuffer>> read_message() override {
         while(read_index >= incoming_messages.size()) {
             if(closed) {
                 co_return std::nullopt;
@@ -55,7 +55,7 @@ public:
             readable.reset();
         }
 
-        co_return incoming_messages[read_index++];
+        co_return ipc::MessageBuffer(incoming_messages[read_index++]);
     }
 
     et::task<void, ipc::Error> write_message(std::string_view payload) override {
@@ -0,0 +1,200 @@
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "kota/ipc/shm_transport.h"
+#include "kota/ipc/transport.h"
+#include "kota/async/async.h"
+
+namespace et = kota;
+namespace ipc = et::ipc;
+
+// Sends the same stream of messages to a worker over a shared-memory link and over stdio
+// pipes, and reports how fast each one drains it.
+//
+//   shm_throughput [message-count] [message-bytes]
+
+namespace {
+
+struct Workload {
+    std::size_t count = 100'000;
+    std::size_t bytes = 1024;
+};
+
+struct Measurement {
+    std::size_t received = 0;
+    double seconds = 0;
+    std::string error;
+};
+
+std::optional<std::size_t> parse_size(std::string_view text) {
+    std::size_t value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if(ec != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Worker side: count every byte received, then report the total once input ends.
+et::task<> drain(ipc::Transport& transport) {
+    std::size_t received = 0;
+    while(auto message = co_await transport.read_message()) {
+        received += message->size();
+    }
+
+    auto reply = co_await transport.write_message(std::to_string(received));
+    if(!reply) {
+        std::println(stderr, "worker failed to reply: {}", reply.error().message);
+    }
+    (void)transport.close();
+}
+
+int run_worker(std::string_view kind) {
+    et::event_loop loop;
+
+    std::unique_ptr<ipc::Transport> transport;
+    if(kind == "shm") {
+        auto opened = ipc::SharedMemoryTransport::open_inherited(loop);
+        if(!opened) {
+            std::println(stderr, "failed to open shared-memory link: {}", opened.error().message);
+            return 1;
+        }
+        transport = std::move(*opened);
+    } else {
+        auto opened = ipc::StreamTransport::open_stdio(loop);
+        if(!opened) {
+            std::println(stderr, "failed to open stdio transport: {}", opened.error().message);
+            return 1;
+        }
+        transport = std::move(*opened);
+    }
+
+    auto task = drain(*transport);
+    loop.schedule(task);
+    return loop.run();
+}
+
+et::task<> send_workload(ipc::Transport& transport,
+                         et::process child,
+                         Workload workload,
+                         Measurement& out) {
+    const std::string payload(workload.bytes, 'x');
+    const auto start = std::chrono::steady_clock::now();
+
+    for(std::size_t i = 0; i < workload.count; ++i) {
+        auto written = co_await transport.write_message(payload);
+        if(!written) {
+            out.error = "write failed: " + written.error().message;
+            break;
+        }
+    }
+    (void)transport.close_output();
+
+    // The worker replies only after it has read everything, so this stops the clock.
+    auto reply = co_await transport.read_message();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(reply) {
+        out.received = parse_size(reply->view()).value_or(0);
+    } else if(out.error.empty()) {
+        out.error = "worker closed the link without replying";
+    }
+    (void)transport.close();
+
+    auto status = co_await child.wait();
+    if(out.error.empty() && (!status || status->status != 0 || status->term_signal != 0)) {
+        out.error = "worker exited unexpectedly";
+    }
+}
+
+Measurement measure(const std::string& self_path, std::string_view kind, Workload workload) {
+    et::event_loop loop;
+    Measurement out;
+
+    et::process::options opts;
+    opts.file = self_path;
+    opts.args = {self_path, "--worker", std::string(kind)};
+
+    std::unique_ptr<ipc::Transport> transport;
+    et::process child;
+    if(kind == "shm") {
+        opts.streams = {
+            et::process::stdio::ignore(),
+            et::process::stdio::ignore(),
+            et::process::stdio::inherit(),
+        };
+        auto spawned = ipc::SharedMemoryTransport::spawn(std::move(opts), loop);
+        if(!spawned) {
+            out.error = "spawn failed: " + spawned.error().message;
+            return out;
+        }
+        child = std::move(spawned->first.proc);
+        transport = std::move(spawned->second);
+    } else {
+        opts.streams = {
+            et::process::stdio::pipe(true, false),
+            et::process::stdio::pipe(false, true),
+            et::process::stdio::inherit(),
+        };
+        auto spawned = et::process::spawn(opts, loop);
+        if(!spawned) {
+            out.error = "spawn failed: " + std::string(spawned.error().message());
+            return out;
+        }
+        child = std::move(spawned->proc);
+        transport = std::make_unique<ipc::StreamTransport>(std::move(spawned->stdout_pipe),
+                                                           std::move(spawned->stdin_pipe));
+    }
+
+    auto task = send_workload(*transport, std::move(child), workload, out);
+    loop.schedule(task);
+    loop.run();
+    return out;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if(argc > 2 && std::string_view(argv[1]) == "--worker") {
+        return run_worker(argv[2]);
+    }
+
+    Workload workload;
+    if(argc > 1) {
+        workload.count = parse_size(argv[1]).value_or(workload.count);
+    }
+    if(argc > 2) {
+        workload.bytes = parse_size(argv[2]).value_or(workload.bytes);
+    }
+
+    const auto self_path = std::filesystem::absolute(argv[0]).string();
+    const auto expected = workload.count * workload.bytes;
+    std::println("{} messages of {} bytes", workload.count, workload.bytes);
+
+    int status = 0;
+    for(std::string_view kind: {"stream", "shm"}) {
+        auto result = measure(self_path, kind, workload);
+        if(!result.error.empty() || result.received != expected) {
+            std::println(stderr,
+                         "{}: {}",
+                         kind,
+                         result.error.empty() ? "worker saw the wrong byte count" : result.error);
+            status = 1;
+            continue;
+        }
+
+        const auto mib = static_cast<double>(expected) / (1024.0 * 1024.0);
+        std::println("{:>6}: {:8.3f} s  {:10.1f} MiB/s  {:12.0f} msg/s",
+                     kind,
+                     result.seconds,
+                     mib / result.seconds,
+                     static_cast<double>(workload.count) / result.seconds);
+    }
+    return status;
+}
@@ -9,6 +9,7 @@
 #include "kota/async/io/stream.h"
 #include "kota/async/io/system.h"
 #include "kota/async/io/task_group.h"
+#include "kota/async/io/thread_pool.h"
 #include "kota/async/io/udp.h"
 #include "kota/async/io/watcher.h"
 #include "kota/async/runtime/frame.h"
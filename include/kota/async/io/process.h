@@ -108,6 +108,9 @@ public:
 
         /// Stdio config for stdin/stdout/stderr.
         std::array<stdio, 3> streams = {stdio::inherit(), stdio::inherit(), stdio::inherit()};
+
+        /// Additional descriptors inherited by the child as fds 3, 4, ... in order.
+        std::vector<int> extra_fds;
     };
 
     using wait_result = result<exit_status>;
@@ -64,6 +64,11 @@ public:
     /// Write data to the stream; only one writer at a time.
     task<void, error> write(std::span<const char> data);
 
+    /// Gather-write several buffers with a single uv_write; only one writer at a time.
+    /// Unlike the single-buffer overload the bytes are not copied, so every buffer must stay
+    /// alive until the returned task completes.
+    task<void, error> write(std::span<const std::span<const char>> buffers);
+
     /// Try a non-blocking write; returns bytes written or error.
     result<std::size_t> try_write(std::span<const char> data);
 
@@ -76,6 +81,21 @@ public:
     /// Enable or disable blocking I/O on the stream.
     error set_blocking(bool enabled);
 
+    /// Write data with a file descriptor attached; the descriptor arrives together with the
+    /// first byte of `data`. Only IPC pipes (pipe::options::ipc) on Unix can carry descriptors.
+    /// `fd` is duplicated, so the caller keeps ownership of it.
+    task<void, error> write_with_fd(std::span<const char> data, int fd);
+
+    /// Check whether write_with_fd() can be used, i.e. the stream is an IPC pipe on Unix.
+    bool can_send_fds() const noexcept;
+
+    /// Number of received descriptors waiting to be taken; always 0 unless an IPC pipe.
+    std::size_t pending_fds() const noexcept;
+
+    /// Take the oldest received descriptor. Descriptors become available as the bytes they
+    /// were sent with are read. The caller owns the returned (close-on-exec) descriptor.
+    result<int> take_pending_fd();
+
 protected:
     explicit stream(unique_handle<Self> self) noexcept;
 
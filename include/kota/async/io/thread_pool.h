@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "kota/support/functional.h"
+#include "kota/async/io/loop.h"
+#include "kota/async/runtime/task.h"
+
+namespace kota {
+
+/// A fixed set of threads for blocking work, separate from libuv's worker pool.
+///
+/// queue() shares libuv's process-wide pool with file-system and DNS requests; it has four
+/// threads unless UV_THREADPOOL_SIZE says otherwise, so a few long jobs there hold up every
+/// fs operation in the process. Work given to a thread_pool only ever competes with other
+/// work given to the same pool.
+///
+/// Every run() must have completed before the pool is destroyed.
+class thread_pool {
+public:
+    /// Start `threads` threads; zero is treated as one.
+    explicit thread_pool(std::size_t threads);
+
+    thread_pool(const thread_pool&) = delete;
+
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool();
+
+    std::size_t size() const noexcept;
+
+    /// Run `fn` on one of the pool's threads and complete on `loop` once it has returned.
+    /// Cancelling before a thread picks the work up drops it; after that, cancellation
+    /// completes only once `fn` has returned.
+    task<> run(function<void()> fn, event_loop& loop = event_loop::current());
+
+    /// Opaque implementation detail. Defined in thread_pool.cpp.
+    struct self;
+
+private:
+    std::unique_ptr<self> self;
+};
+
+}  // namespace kota
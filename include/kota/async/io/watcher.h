@@ -1,7 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
+#include "kota/support/functional.h"
 #include "kota/async/runtime/task.h"
 #include "kota/async/vocab/error.h"
 #include "kota/async/vocab/owned.h"
@@ -155,6 +157,53 @@ private:
     unique_handle<Self> self;
 };
 
+struct timer_wheel;
+
+namespace detail {
+
+struct timer_link {
+    timer_link* prev = nullptr;
+    timer_link* next = nullptr;
+};
+
+}  // namespace detail
+
+/// One-shot callback on the loop's shared timer wheel. Unlike `timer` it owns no libuv
+/// handle: every deadline on a loop is driven by a single uv_timer_t, and arming or cancelling
+/// one is O(1) and does not allocate. Resolution is one millisecond of loop time. While armed
+/// the object is linked into the wheel, so it is neither copyable nor movable; destroying it
+/// cancels it.
+class deadline : detail::timer_link {
+public:
+    explicit deadline(event_loop& loop = event_loop::current()) noexcept;
+
+    deadline(const deadline&) = delete;
+    deadline& operator=(const deadline&) = delete;
+
+    ~deadline();
+
+    /// Run `callback` on the loop once `timeout` has elapsed, replacing any earlier arming.
+    /// The callback may destroy or re-arm this deadline.
+    void arm(std::chrono::milliseconds timeout, function<void()> callback);
+
+    /// Disarm without running the callback. Does nothing if not armed.
+    void cancel() noexcept;
+
+    bool armed() const noexcept {
+        return wheel != nullptr;
+    }
+
+private:
+    friend struct timer_wheel;
+
+    event_loop* loop;
+    timer_wheel* wheel = nullptr;
+    std::uint64_t expires = 0;
+    std::uint8_t level = 0;
+    std::uint8_t slot = 0;
+    function<void()> callback{+[] {}};
+};
+
 task<> sleep(std::chrono::milliseconds timeout, event_loop& loop = event_loop::current());
 
 inline task<> sleep(int ms, event_loop& loop = event_loop::current()) {
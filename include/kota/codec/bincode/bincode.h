@@ -37,4 +37,20 @@ struct deserialize_traits<bincode::Deserializer<Config>, RawValue> {
     }
 };
 
+template <typename Config>
+struct deserialize_traits<bincode::Deserializer<Config>, RawValueView> {
+    using error_type = typename bincode::Deserializer<Config>::error_type;
+
+    static auto deserialize(bincode::Deserializer<Config>& deserializer, RawValueView& value)
+        -> std::expected<void, error_type> {
+        std::span<const std::byte> bytes;
+        auto status = deserializer.deserialize_bytes_view(bytes);
+        if(!status) {
+            return std::unexpected(status.error());
+        }
+        value.data = std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return {};
+    }
+};
+
 }  // namespace kota::codec
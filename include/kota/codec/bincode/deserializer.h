@@ -156,6 +156,19 @@ public:
         return {};
     }
 
+    /// Like deserialize_bytes, but returns a view into the input instead of copying.
+    status_t deserialize_bytes_view(std::span<const std::byte>& value) {
+        KOTA_EXPECTED_TRY_V(auto length, read_length());
+
+        if(offset + length > bytes.size()) {
+            return mark_invalid(error_kind::unexpected_eof);
+        }
+
+        value = bytes.subspan(offset, length);
+        offset += length;
+        return {};
+    }
+
     result_t<bool> deserialize_none() {
         KOTA_EXPECTED_TRY_V(auto tag, read_u8());
 
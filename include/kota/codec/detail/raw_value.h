@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 
 namespace kota::codec {
 
@@ -11,4 +12,14 @@ struct RawValue {
     }
 };
 
+/// Borrowed counterpart of RawValue: points into the buffer being deserialized, so it is only
+/// valid while that buffer is alive.
+struct RawValueView {
+    std::string_view data;
+
+    bool empty() const noexcept {
+        return data.empty();
+    }
+};
+
 }  // namespace kota::codec
@@ -121,6 +121,35 @@ struct simdjson_source_adapter {
 
 }  // namespace detail
 
+/// Reusable parsing state for from_json. A simdjson parser keeps its structural index sized for
+/// the largest document it has seen, and the padded input copy keeps its capacity, so feeding
+/// many messages through one context avoids reallocating both per call. A context parses one
+/// document at a time and must outlive any Deserializer built on it.
+class parse_context {
+public:
+    parse_context() = default;
+
+    parse_context(const parse_context&) = delete;
+    parse_context& operator=(const parse_context&) = delete;
+
+    parse_context(parse_context&&) noexcept = default;
+    parse_context& operator=(parse_context&&) noexcept = default;
+
+private:
+    template <typename Config>
+    friend class Deserializer;
+
+    simdjson::padded_string_view pad(std::string_view json) {
+        buffer.clear();
+        buffer.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+        buffer.append(json);
+        return simdjson::padded_string_view(buffer.data(), buffer.size(), buffer.capacity());
+    }
+
+    simdjson::ondemand::parser parser;
+    std::string buffer;
+};
+
 template <typename Config = config::default_config>
 class Deserializer {
 public:
@@ -143,6 +172,15 @@ public:
         initialize_document(json);
     }
 
+    /// Parse with the parser and input buffer of `context` instead of private ones.
+    Deserializer(std::string_view json, parse_context& shared) : context(&shared) {
+        initialize_document(shared.pad(json));
+    }
+
+    Deserializer(simdjson::padded_string_view json, parse_context& shared) : context(&shared) {
+        initialize_document(json);
+    }
+
     bool valid() const {
         return is_valid;
     }
@@ -674,7 +712,8 @@ private:
     void initialize_document(simdjson::padded_string_view json) {
         input_view = json;
 
-        auto document_result = parser.iterate(json);
+        auto& active_parser = context != nullptr ? context->parser : parser;
+        auto document_result = active_parser.iterate(json);
         auto err = std::move(document_result).get(document);
         if(err != simdjson::SUCCESS) {
             (void)mark_invalid(err);
@@ -755,7 +794,9 @@ private:
     std::vector<deser_frame> deser_stack;
     std::vector<array_frame> array_stack;
 
+    // Unused (and never allocates) when a parse_context is supplied.
     simdjson::ondemand::parser parser;
+    parse_context* context = nullptr;
     simdjson::padded_string json_buffer;
     simdjson::padded_string_view input_view{};
     simdjson::ondemand::document document;
@@ -785,6 +826,33 @@ auto from_json(simdjson::padded_string_view json, T& value) -> std::expected<voi
     return deserializer.finish();
 }
 
+/// Overloads that reuse the parser and input buffer of `context` across calls.
+template <typename Config = config::default_config, typename T>
+auto from_json(parse_context& context, std::string_view json, T& value)
+    -> std::expected<void, error> {
+    Deserializer<Config> deserializer(json, context);
+    if(!deserializer.valid()) {
+        return std::unexpected(deserializer.error());
+    }
+
+    KOTA_EXPECTED_TRY(codec::deserialize(deserializer, value));
+
+    return deserializer.finish();
+}
+
+template <typename Config = config::default_config, typename T>
+auto from_json(parse_context& context, simdjson::padded_string_view json, T& value)
+    -> std::expected<void, error> {
+    Deserializer<Config> deserializer(json, context);
+    if(!deserializer.valid()) {
+        return std::unexpected(deserializer.error());
+    }
+
+    KOTA_EXPECTED_TRY(codec::deserialize(deserializer, value));
+
+    return deserializer.finish();
+}
+
 template <typename T, typename Config = config::default_config>
     requires std::default_initializable<T>
 auto from_json(std::string_view json) -> std::expected<T, error> {
@@ -801,6 +869,23 @@ auto from_json(simdjson::padded_string_view json) -> std::expected<T, error> {
     return value;
 }
 
+template <typename T, typename Config = config::default_config>
+    requires std::default_initializable<T>
+auto from_json(parse_context& context, std::string_view json) -> std::expected<T, error> {
+    T value{};
+    KOTA_EXPECTED_TRY(from_json<Config>(context, json, value));
+    return value;
+}
+
+template <typename T, typename Config = config::default_config>
+    requires std::default_initializable<T>
+auto from_json(parse_context& context, simdjson::padded_string_view json)
+    -> std::expected<T, error> {
+    T value{};
+    KOTA_EXPECTED_TRY(from_json<Config>(context, json, value));
+    return value;
+}
+
 static_assert(codec::deserializer_like<Deserializer<>>);
 
 }  // namespace kota::codec::json
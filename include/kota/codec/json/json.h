@@ -87,4 +87,19 @@ struct deserialize_traits<json::Deserializer<Config>, RawValue> {
     }
 };
 
+template <typename Config>
+struct deserialize_traits<json::Deserializer<Config>, RawValueView> {
+    using error_type = typename json::Deserializer<Config>::error_type;
+
+    static auto deserialize(json::Deserializer<Config>& deserializer, RawValueView& value)
+        -> std::expected<void, error_type> {
+        auto raw = deserializer.deserialize_raw_json_view();
+        if(!raw) {
+            return std::unexpected(raw.error());
+        }
+        value.data = std::string_view(raw->data(), raw->size());
+        return {};
+    }
+};
+
 }  // namespace kota::codec
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <variant>
 
 #include "kota/ipc/protocol.h"
@@ -13,16 +17,107 @@ using Error = protocol::Error;
 template <typename T>
 using Result = outcome<T, Error>;
 
+/// Owned incoming payload whose storage is followed by `padding` zero bytes. Transports fill
+/// it straight from the wire, parsed messages borrow their params from it, and because any
+/// subrange is followed by at least `padding` readable bytes, SIMD parsers may decode those
+/// views in place without re-padding.
+class MessageBuffer {
+public:
+    constexpr static std::size_t padding = 64;
+
+    MessageBuffer() = default;
+
+    /// Frees storage that MessageBuffer did not allocate itself, e.g. a memory mapping.
+    using release_fn = void (*)(char* data, std::size_t capacity) noexcept;
+
+    /// Allocate `size` payload bytes, left for the caller to fill through data().
+    explicit MessageBuffer(std::size_t size) :
+        storage(std::make_unique_for_overwrite<char[]>(size + padding).release()), length(size) {
+        std::memset(storage.get() + length, 0, padding);
+    }
+
+    explicit MessageBuffer(std::string_view payload) : MessageBuffer(payload.size()) {
+        if(!payload.empty()) {
+            std::memcpy(storage.get(), payload.data(), payload.size());
+        }
+    }
+
+    char* data() noexcept {
+        return storage.get();
+    }
+
+    const char* data() const noexcept {
+        return storage.get();
+    }
+
+    std::size_t size() const noexcept {
+        return length;
+    }
+
+    bool empty() const noexcept {
+        return length == 0;
+    }
+
+    std::string_view view() const noexcept {
+        return {storage.get(), length};
+    }
+
+    /// Take ownership of `capacity` bytes at `data`, the first `size` of which are the payload.
+    /// The bytes after the payload must be readable and zero, at least `padding` of them.
+    /// `release` is called with `data` and `capacity` when the buffer dies. The storage may be
+    /// read-only; data() must not be written through then.
+    static MessageBuffer adopt(char* data,
+                               std::size_t size,
+                               std::size_t capacity,
+                               release_fn release) noexcept {
+        MessageBuffer buffer;
+        buffer.storage = std::unique_ptr<char[], deleter>(data, deleter{release, capacity});
+        buffer.length = size;
+        return buffer;
+    }
+
+private:
+    // No member initializers: unique_ptr value-initializes its deleter, and initializers
+    // would leave this type incomplete for that check inside MessageBuffer.
+    struct deleter {
+        release_fn release;
+        std::size_t capacity;
+
+        void operator()(char* data) const noexcept {
+            if(release != nullptr) {
+                release(data, capacity);
+            } else {
+                delete[] data;
+            }
+        }
+    };
+
+    std::unique_ptr<char[], deleter> storage;
+    std::size_t length = 0;
+};
+
 /// Typed incoming message alternatives (codec-agnostic).
+///
+/// Request and notification params are views into `payload`, which keeps the buffer alive for
+/// as long as the message (or a copy of the pointer) is held. `method` normally points into
+/// `payload` as well; a codec that has to unescape it may instead point into its own scratch
+/// storage, which stays valid until that codec parses the next message.
+///
+/// `size` is the encoded length of the message itself. It is smaller than `payload` when the
+/// message is one element of a batch, since every element shares the batch's buffer.
 struct IncomingRequest {
     protocol::RequestID id;
-    std::string method;
-    std::string params;
+    std::string_view method;
+    std::string_view params;
+    std::shared_ptr<const MessageBuffer> payload;
+    std::size_t size = 0;
 };
 
 struct IncomingNotification {
-    std::string method;
-    std::string params;
+    std::string_view method;
+    std::string_view params;
+    std::shared_ptr<const MessageBuffer> payload;
+    std::size_t size = 0;
 };
 
 struct IncomingResponse {
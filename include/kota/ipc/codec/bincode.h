@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <memory>
 #include <span>
 #include <string>
 
@@ -51,7 +52,11 @@ namespace kota::ipc {
 
 class BincodeCodec {
 public:
-    IncomingMessage parse_message(std::string_view payload);
+    IncomingMessage parse_message(std::shared_ptr<const MessageBuffer> payload);
+
+    IncomingMessage parse_message(std::string_view payload) {
+        return parse_message(std::make_shared<const MessageBuffer>(payload));
+    }
 
     Result<std::string> encode_request(const protocol::RequestID& id,
                                        std::string_view method,
@@ -64,6 +69,38 @@ public:
 
     Result<std::string> encode_error_response(const protocol::RequestID& id, const Error& error);
 
+    /// Typed encoders. Bincode embeds params/results as a length-prefixed byte blob, so the
+    /// value is serialized first and then wrapped by the untyped encoders.
+    template <typename T>
+    Result<std::string> encode_request_value(const protocol::RequestID& id,
+                                             std::string_view method,
+                                             const T& params) {
+        auto serialized = serialize_value(params);
+        if(!serialized) {
+            return outcome_error(serialized.error());
+        }
+        return encode_request(id, method, *serialized);
+    }
+
+    template <typename T>
+    Result<std::string> encode_notification_value(std::string_view method, const T& params) {
+        auto serialized = serialize_value(params);
+        if(!serialized) {
+            return outcome_error(serialized.error());
+        }
+        return encode_notification(method, *serialized);
+    }
+
+    template <typename T>
+    Result<std::string> encode_success_response_value(const protocol::RequestID& id,
+                                                      const T& result) {
+        auto serialized = serialize_value(result);
+        if(!serialized) {
+            return outcome_error(serialized.error());
+        }
+        return encode_success_response(id, *serialized);
+    }
+
     template <typename T>
     Result<std::string> serialize_value(const T& value) {
         auto bytes = codec::bincode::to_bytes(value);
@@ -93,6 +130,13 @@ public:
         }
         return value;
     }
+
+    /// Bincode needs no padding, so borrowed params decode exactly like any other value.
+    template <typename T>
+    Result<T> deserialize_params(std::string_view raw,
+                                 protocol::ErrorCode code = protocol::ErrorCode::RequestFailed) {
+        return deserialize_value<T>(raw, code);
+    }
 };
 
 using BincodePeer = Peer<BincodeCodec>;
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <deque>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 #include "kota/ipc/codec.h"
 #include "kota/ipc/peer.h"
+#include "kota/support/expected_try.h"
 #include "kota/codec/detail/config.h"
 #include "kota/codec/detail/raw_value.h"
 #include "kota/codec/detail/spelling.h"
@@ -17,7 +25,25 @@ struct lsp_config {
 
 class JsonCodec {
 public:
-    IncomingMessage parse_message(std::string_view payload);
+    IncomingMessage parse_message(std::shared_ptr<const MessageBuffer> payload);
+
+    IncomingMessage parse_message(std::string_view payload) {
+        return parse_message(std::make_shared<const MessageBuffer>(payload));
+    }
+
+    /// True if `payload` is a JSON-RPC batch, i.e. its top-level value is an array.
+    static bool is_batch(std::string_view payload) noexcept;
+
+    /// Parse every element of a batch into `out` (replacing its contents), in order. The
+    /// messages borrow from `payload` as parse_message()'s do; unescaped method names stay
+    /// valid until the next parse. Returns false if `payload` is not a non-empty array; `out`
+    /// then holds the single parse error to answer on its own, outside any batch.
+    bool parse_batch(std::shared_ptr<const MessageBuffer> payload,
+                     std::vector<IncomingMessage>& out);
+
+    /// Join already encoded messages into one batch payload. Messages that are batches
+    /// themselves contribute their elements, so the result is never nested.
+    std::string encode_batch(std::span<const std::string> messages);
 
     Result<std::string> encode_request(const protocol::RequestID& id,
                                        std::string_view method,
@@ -30,6 +56,43 @@ public:
 
     Result<std::string> encode_error_response(const protocol::RequestID& id, const Error& error);
 
+    /// Typed counterparts of the encoders above: the value is written by the same serializer
+    /// pass as the envelope, so it is never materialized as a separate string first.
+    template <typename T>
+    Result<std::string> encode_request_value(const protocol::RequestID& id,
+                                             std::string_view method,
+                                             const T& params) {
+        return encode_envelope([&](auto& serializer) -> envelope_status {
+            KOTA_EXPECTED_TRY(serializer.field("id"));
+            KOTA_EXPECTED_TRY(codec::serialize(serializer, id));
+            KOTA_EXPECTED_TRY(serializer.field("method"));
+            KOTA_EXPECTED_TRY(serializer.serialize_str(method));
+            KOTA_EXPECTED_TRY(serializer.field("params"));
+            return codec::serialize(serializer, params);
+        });
+    }
+
+    template <typename T>
+    Result<std::string> encode_notification_value(std::string_view method, const T& params) {
+        return encode_envelope([&](auto& serializer) -> envelope_status {
+            KOTA_EXPECTED_TRY(serializer.field("method"));
+            KOTA_EXPECTED_TRY(serializer.serialize_str(method));
+            KOTA_EXPECTED_TRY(serializer.field("params"));
+            return codec::serialize(serializer, params);
+        });
+    }
+
+    template <typename T>
+    Result<std::string> encode_success_response_value(const protocol::RequestID& id,
+                                                      const T& result) {
+        return encode_envelope([&](auto& serializer) -> envelope_status {
+            KOTA_EXPECTED_TRY(serializer.field("id"));
+            KOTA_EXPECTED_TRY(codec::serialize(serializer, id));
+            KOTA_EXPECTED_TRY(serializer.field("result"));
+            return codec::serialize(serializer, result);
+        });
+    }
+
     template <typename T>
     Result<std::string> serialize_value(const T& value) {
         auto serialized = codec::json::to_string<lsp_config>(value);
@@ -50,12 +113,72 @@ public:
                 raw = "{}";
             }
         }
-        auto parsed = codec::json::parse<T, lsp_config>(raw);
+        auto parsed = codec::json::from_json<T, lsp_config>(json_context, raw);
+        if(!parsed) {
+            return outcome_error(Error(code, parsed.error().to_string()));
+        }
+        return std::move(*parsed);
+    }
+
+    /// Decode params borrowed from a MessageBuffer in place: its zeroed tail already provides
+    /// the padding simdjson needs, so the params are not copied into a fresh padded string.
+    template <typename T>
+    Result<T> deserialize_params(std::string_view raw,
+                                 protocol::ErrorCode code = protocol::ErrorCode::RequestFailed) {
+        static_assert(MessageBuffer::padding >= simdjson::SIMDJSON_PADDING);
+        if(raw.empty()) {
+            return deserialize_value<T>(raw, code);
+        }
+        auto padded =
+            simdjson::padded_string_view(raw.data(), raw.size(), raw.size() + MessageBuffer::padding);
+        auto parsed = codec::json::from_json<T, lsp_config>(json_context, padded);
         if(!parsed) {
             return outcome_error(Error(code, parsed.error().to_string()));
         }
         return std::move(*parsed);
     }
+
+private:
+    using envelope_status = std::expected<void, codec::json::error_kind>;
+
+    // Writes `{"jsonrpc":"2.0"`, lets `fields` append the rest of the members and closes the
+    // object, all into one serializer buffer.
+    template <typename Fields>
+    static Result<std::string> encode_envelope(Fields&& fields) {
+        codec::json::Serializer<lsp_config> serializer;
+        auto status = [&]() -> envelope_status {
+            KOTA_EXPECTED_TRY(serializer.begin_object(0));
+            KOTA_EXPECTED_TRY(serializer.field("jsonrpc"));
+            KOTA_EXPECTED_TRY(serializer.serialize_str("2.0"));
+            KOTA_EXPECTED_TRY(fields(serializer));
+            KOTA_EXPECTED_TRY(serializer.end_object());
+            return {};
+        }();
+        if(!status) {
+            return outcome_error(Error(protocol::ErrorCode::InternalError,
+                                       codec::json::error(status.error()).to_string()));
+        }
+
+        auto encoded = serializer.str();
+        if(!encoded) {
+            return outcome_error(Error(protocol::ErrorCode::InternalError,
+                                       codec::json::error(encoded.error()).to_string()));
+        }
+        return std::move(*encoded);
+    }
+
+    // Shared by every decode on this codec so the simdjson parser and input buffer keep their
+    // capacity from one message to the next.
+    codec::json::parse_context json_context;
+
+    IncomingMessage parse_envelope(std::string_view text,
+                                   std::shared_ptr<const MessageBuffer> payload,
+                                   std::string& scratch);
+
+    // Holds a method name that had to be unescaped; see IncomingRequest::method. A batch may
+    // need several at once, so its elements use `batch_scratch` instead.
+    std::string method_scratch;
+    std::deque<std::string> batch_scratch;
 };
 
 using JsonPeer = Peer<JsonCodec>;
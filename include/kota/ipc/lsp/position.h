@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -57,6 +58,20 @@ public:
     /// Returns `std::nullopt` when the position is out of range.
     std::optional<std::uint32_t> to_offset(protocol::Position position) const;
 
+    /// Converts many byte offsets; same results as calling `to_position` on each.
+    ///
+    /// Meant for ascending offsets, as produced for semantic tokens, inlay hints or highlights.
+    /// The line table is then walked forward once instead of searched per offset. Columns on
+    /// a line continue from the previous offset instead of decoding from the line start. An
+    /// offset smaller than its predecessor is still handled, by starting a fresh search.
+    std::vector<std::optional<protocol::Position>>
+        to_positions(std::span<const std::uint32_t> offsets) const;
+
+    /// Converts many LSP positions; same results as calling `to_offset` on each.
+    /// Positions sorted by line, then character, reuse the decode cursor within a line.
+    std::vector<std::optional<std::uint32_t>>
+        to_offsets(std::span<const protocol::Position> positions) const;
+
     /// Measures `text` length in the current position encoding.
     std::uint32_t measure(std::string_view text) const;
 
@@ -64,6 +79,9 @@ private:
     std::string_view content;
     PositionEncoding encoding;
     std::vector<std::uint32_t> line_starts;
+
+    // Per line: true when it holds only ASCII, so columns are the same in every encoding.
+    std::vector<bool> ascii_lines;
 };
 
 }  // namespace kota::ipc::lsp
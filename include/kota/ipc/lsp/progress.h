@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "kota/ipc/peer.h"
 #include "kota/ipc/lsp/protocol.h"
@@ -80,4 +83,83 @@ private:
     }
 };
 
+/// `$/progress` params carrying a chunk of partial results. Unlike ProgressParams the value is
+/// typed, so elements are serialized once, straight into the notification.
+template <typename Value>
+struct PartialResultProgress {
+    protocol::ProgressToken token;
+    Value value;
+};
+
+/// Sends an array result in chunks while a request handler is still producing it. The handler
+/// drives it: it reads `partialResultToken` from its params, pushes elements and returns what
+/// finish() gives back. With a token, every `chunk_size` elements go out as one `$/progress`
+/// notification and finish() returns the empty final result the protocol asks for. Without a
+/// token nothing is sent early and finish() returns every element, as a plain handler would.
+///
+/// `Value` is the partial result type. It is the element array itself for most methods, or an
+/// aggregate whose first member is that array, such as SemanticTokensPartialResult with
+/// `T = uinteger`; pick a `chunk_size` that is a multiple of 5 there, so no token is split.
+///
+/// Before sending a chunk, push() waits for space in the peer's outgoing queue. With outgoing
+/// limits set, a fast producer is paced by the transport instead of building the whole result
+/// in memory.
+template <typename PeerT, typename T, typename Value = std::vector<T>>
+class PartialResultWriter {
+public:
+    PartialResultWriter(PeerT& peer,
+                        std::optional<protocol::ProgressToken> token,
+                        std::size_t chunk_size = 256) :
+        peer(peer), token(std::move(token)), chunk_size(chunk_size == 0 ? 1 : chunk_size) {}
+
+    /// True if elements are sent as partial results rather than in the final response.
+    bool streaming() const noexcept {
+        return token.has_value();
+    }
+
+    /// Add one element, sending the pending chunk once it is full.
+    task<void, Error> push(T element) {
+        pending.push_back(std::move(element));
+        if(token && pending.size() >= chunk_size) {
+            co_await flush().or_fail();
+        }
+    }
+
+    /// Send the pending elements now, even if the chunk is not full. Does nothing without a
+    /// token.
+    task<void, Error> flush() {
+        if(!token || pending.empty()) {
+            co_return;
+        }
+
+        co_await peer.wait_for_outgoing_space();
+        auto chunk = std::exchange(pending, {});
+        co_await or_fail(peer.send_notification(
+            "$/progress",
+            PartialResultProgress<Value>{*token, wrap(std::move(chunk))}));
+    }
+
+    /// Send what is left and return the value for the final response: empty when streaming,
+    /// otherwise every element pushed.
+    task<Value, Error> finish() {
+        co_await flush().or_fail();
+        co_return wrap(std::exchange(pending, {}));
+    }
+
+    PeerT& peer;
+    std::optional<protocol::ProgressToken> token;
+
+private:
+    static Value wrap(std::vector<T> elements) {
+        if constexpr(std::is_same_v<Value, std::vector<T>>) {
+            return elements;
+        } else {
+            return Value{std::move(elements)};
+        }
+    }
+
+    std::size_t chunk_size;
+    std::vector<T> pending;
+};
+
 }  // namespace kota::ipc::lsp
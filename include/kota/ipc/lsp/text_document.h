@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "kota/ipc/lsp/position.h"
+#include "kota/ipc/lsp/protocol.h"
+
+namespace kota::ipc::lsp {
+
+namespace detail {
+
+struct rope_node;
+
+}  // namespace detail
+
+/// Mutable text of one open document, edited in place by `didChange` events.
+///
+/// The text is split into chunks of at most `chunk_bytes` held in a balanced tree (a rope).
+/// Every node caches the byte and newline counts of its subtree. Finding a line start, the line
+/// of an offset, or the chunk holding an offset is O(log n). An edit splits the tree at the
+/// range, drops the old chunks and links in new ones, so it costs O(log n + edit size) and
+/// never re-indexes the rest of the file. As in `PositionMapper`, only '\n' ends a line and
+/// positions are counted in the document's `PositionEncoding`; converting one walks its line.
+class TextDocument {
+public:
+    /// Largest chunk the rope stores. Edits re-split merged chunks to stay within this size.
+    constexpr static std::uint32_t chunk_bytes = 1024;
+
+    TextDocument(std::string_view content, PositionEncoding encoding);
+
+    TextDocument(TextDocument&& other) noexcept;
+    TextDocument& operator=(TextDocument&& other) noexcept;
+
+    ~TextDocument();
+
+    PositionEncoding position_encoding() const noexcept {
+        return encoding;
+    }
+
+    /// Total size in bytes.
+    std::uint32_t size() const noexcept;
+
+    /// Number of lines; one more than the number of '\n'.
+    std::uint32_t line_count() const noexcept;
+
+    /// Returns the zero-based line containing `offset`.
+    std::uint32_t line_of(std::uint32_t offset) const;
+
+    /// Returns the byte offset of the start of `line`.
+    std::uint32_t line_start(std::uint32_t line) const;
+
+    /// Returns the byte offset one past the line content (excluding '\n').
+    std::uint32_t line_end_exclusive(std::uint32_t line) const;
+
+    /// Converts a byte offset to LSP `Position{line, character}`.
+    /// Returns `std::nullopt` when the offset is out of range.
+    std::optional<protocol::Position> to_position(std::uint32_t offset) const;
+
+    /// Converts LSP position to a byte offset in the current text.
+    /// Returns `std::nullopt` when the position is out of range.
+    std::optional<std::uint32_t> to_offset(protocol::Position position) const;
+
+    /// Copies bytes `[begin, end)`.
+    std::string text(std::uint32_t begin, std::uint32_t end) const;
+
+    /// Copies the whole document.
+    std::string text() const;
+
+    /// Replaces bytes `[begin, end)` with `replacement`.
+    void replace(std::uint32_t begin, std::uint32_t end, std::string_view replacement);
+
+    /// Applies one `didChange` content change.
+    ///
+    /// Follows the LSP rules for ranges: a character past the end of its line means the line
+    /// end, and a line past the last line means the end of the document. Returns false, and
+    /// leaves the text unchanged, if the range is reversed or ends inside a code point.
+    bool apply(const protocol::TextDocumentContentChangeEvent& change);
+
+    /// Applies `changes` in order, stopping at the first one that fails.
+    bool apply(std::span<const protocol::TextDocumentContentChangeEvent> changes);
+
+private:
+    // Offset of `position` under the LSP clamping rules used by apply().
+    std::optional<std::uint32_t> resolve(protocol::Position position) const;
+
+    // Bytes [begin, end) as one view; copies into `scratch` only when they span chunks.
+    std::string_view slice(std::uint32_t begin, std::uint32_t end, std::string& scratch) const;
+
+    PositionEncoding encoding;
+    std::uint32_t seed;
+    std::unique_ptr<detail::rope_node> root;
+};
+
+}  // namespace kota::ipc::lsp
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <expected>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -86,4 +87,53 @@ private:
     Segment fragment_segment;
 };
 
+namespace detail {
+
+struct uri_shard;
+
+}  // namespace detail
+
+/// A URI seen by a `URIInterner`, with its parse and file path computed once.
+///
+/// Owned by the interner and never moved, so callers hold it by pointer and may compare
+/// entries by address.
+struct InternedURI {
+    /// The URI text exactly as it was interned.
+    std::string text;
+
+    /// `URI::parse(text)`.
+    URI uri;
+
+    /// `uri.file_path()`; holds its error for non-file or undecodable URIs.
+    std::expected<std::string, std::string> file_path;
+};
+
+/// Thread-safe cache from URI text to `InternedURI`.
+///
+/// The first lookup of a text parses and decodes it; every later one is a hash probe under a
+/// shared lock and returns the same entry. The table is split into shards, each with its own
+/// lock, so concurrent handlers seldom contend. Paths given to `intern_file_path` are cached
+/// the same way. Entries live as long as the interner; texts that fail to parse are not stored.
+class URIInterner {
+public:
+    URIInterner();
+
+    URIInterner(const URIInterner&) = delete;
+    URIInterner& operator=(const URIInterner&) = delete;
+
+    ~URIInterner();
+
+    /// Returns the entry for `text`, parsing it if it has not been seen yet.
+    std::expected<const InternedURI*, std::string> intern(std::string_view text);
+
+    /// Returns the entry for the `file://` URI built from `path` by `URI::from_file_path`.
+    std::expected<const InternedURI*, std::string> intern_file_path(std::string_view path);
+
+    /// Number of distinct URI texts interned.
+    std::size_t size() const;
+
+private:
+    std::unique_ptr<detail::uri_shard[]> shards;
+};
+
 }  // namespace kota::ipc::lsp
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kota::ipc::detail {
+
+/// Method-name → value table used for Peer dispatch. Names are copied once at registration;
+/// lookups take a string_view (typically pointing into the incoming payload) and never
+/// allocate. Open addressing with linear probing over a power-of-two slot array kept at most
+/// half full, so a miss usually costs one hash and one probe. Entries are never moved once
+/// inserted, so a found value stays valid while more methods are registered, e.g. by a handler
+/// that is running from it.
+template <typename Value>
+class method_table {
+public:
+    /// Register `value` under `name`, replacing any previous registration.
+    void insert_or_assign(std::string_view name, Value value) {
+        const auto h = hash(name);
+        if(auto index = lookup(name, h); index != npos) {
+            entries[index].value = std::move(value);
+            return;
+        }
+
+        entries.push_back(entry{std::string(name), h, std::move(value)});
+        if(entries.size() * 2 > slots.size()) {
+            rehash(std::bit_ceil(entries.size() * 2));
+        } else {
+            place(entries.size() - 1);
+        }
+    }
+
+    /// Value registered for `name`, or nullptr.
+    Value* find(std::string_view name) noexcept {
+        auto index = lookup(name, hash(name));
+        return index == npos ? nullptr : &entries[index].value;
+    }
+
+    const Value* find(std::string_view name) const noexcept {
+        auto index = lookup(name, hash(name));
+        return index == npos ? nullptr : &entries[index].value;
+    }
+
+    std::size_t size() const noexcept {
+        return entries.size();
+    }
+
+    bool empty() const noexcept {
+        return entries.empty();
+    }
+
+private:
+    struct entry {
+        std::string name;
+        std::uint64_t hash;
+        Value value;
+    };
+
+    // FNV-1a: method names are short ASCII paths, where this beats std::hash's setup cost.
+    static std::uint64_t hash(std::string_view name) noexcept {
+        std::uint64_t h = 14695981039346656037ULL;
+        for(unsigned char ch: name) {
+            h ^= ch;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    constexpr static std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Index of the entry named `name`, or npos.
+    std::size_t lookup(std::string_view name, std::uint64_t h) const noexcept {
+        if(slots.empty()) {
+            return npos;
+        }
+
+        const auto mask = slots.size() - 1;
+        for(auto i = static_cast<std::size_t>(h) & mask;; i = (i + 1) & mask) {
+            const auto slot = slots[i];
+            if(slot == 0) {
+                return npos;
+            }
+            const auto& candidate = entries[slot - 1];
+            if(candidate.hash == h && candidate.name == name) {
+                return slot - 1;
+            }
+        }
+    }
+
+    void place(std::size_t index) {
+        const auto mask = slots.size() - 1;
+        auto i = static_cast<std::size_t>(entries[index].hash) & mask;
+        while(slots[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = static_cast<std::uint32_t>(index + 1);
+    }
+
+    void rehash(std::size_t slot_count) {
+        slots.assign(slot_count, 0);
+        for(std::size_t i = 0; i < entries.size(); ++i) {
+            place(i);
+        }
+    }
+
+    // A deque, so growing never relocates the entries that slots and callers point at.
+    std::deque<entry> entries;
+    // 0 marks an empty slot; otherwise the entry index plus one.
+    std::vector<std::uint32_t> slots;
+};
+
+}  // namespace kota::ipc::detail
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kota::ipc {
+
+/// Fixed-size latency histogram with four sub-buckets per power of two, so a reported
+/// percentile is within 25% of the true value. Recording is a couple of bit operations and an
+/// increment; there is no allocation and no locking, so an instance must stay on one thread.
+class latency_histogram {
+public:
+    void record(std::chrono::nanoseconds duration) noexcept {
+        const auto ns = duration.count() < 0 ? 0 : static_cast<std::uint64_t>(duration.count());
+        ++buckets[bucket_of(ns)];
+        ++total;
+    }
+
+    std::uint64_t count() const noexcept {
+        return total;
+    }
+
+    /// Upper bound of the bucket holding the `q`-quantile (0 < q <= 1); zero when empty.
+    std::chrono::nanoseconds percentile(double q) const noexcept {
+        if(total == 0) {
+            return std::chrono::nanoseconds::zero();
+        }
+
+        auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+        rank = std::clamp<std::uint64_t>(rank, 1, total);
+
+        std::size_t index = 0;
+        for(std::uint64_t seen = buckets[0]; seen < rank && index + 1 < buckets.size();) {
+            seen += buckets[++index];
+        }
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(upper_bound_of(index)));
+    }
+
+    void merge(const latency_histogram& other) noexcept {
+        for(std::size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        total += other.total;
+    }
+
+private:
+    constexpr static std::size_t sub_buckets = 4;
+
+    // Values below 4 get exact buckets; above that, the top set bit selects the octave and the
+    // next two bits the sub-bucket.
+    static std::size_t bucket_of(std::uint64_t ns) noexcept {
+        if(ns < sub_buckets) {
+            return static_cast<std::size_t>(ns);
+        }
+        const auto msb = static_cast<std::size_t>(std::bit_width(ns)) - 1;
+        const auto sub = static_cast<std::size_t>(ns >> (msb - 2)) & (sub_buckets - 1);
+        return (msb - 1) * sub_buckets + sub;
+    }
+
+    static std::uint64_t upper_bound_of(std::size_t index) noexcept {
+        if(index < sub_buckets) {
+            return index;
+        }
+        const auto msb = index / sub_buckets + 1;
+        const auto sub = index % sub_buckets;
+        const auto width = std::uint64_t(1) << (msb - 2);
+        return ((sub_buckets + sub) << (msb - 2)) + (width - 1);
+    }
+
+    std::array<std::uint64_t, 63 * sub_buckets> buckets{};
+    std::uint64_t total = 0;
+};
+
+/// Counters for one inbound method, as returned by Peer::metrics_snapshot().
+struct method_metrics {
+    std::string method;
+
+    /// Requests dispatched to a handler, and requests whose handler has not finished yet.
+    std::uint64_t requests = 0;
+    std::uint64_t in_flight = 0;
+
+    /// Requests answered with RequestCancelled, and requests whose handler failed.
+    std::uint64_t cancelled = 0;
+    std::uint64_t failed = 0;
+
+    std::uint64_t notifications = 0;
+
+    /// Encoded size of the incoming messages and of the responses sent for them.
+    std::uint64_t bytes_in = 0;
+    std::uint64_t bytes_out = 0;
+
+    /// Time from dispatch until the handler finished (requests and notifications).
+    latency_histogram handler_latency;
+
+    /// Time a message spent between being read and being dispatched.
+    latency_histogram queue_wait;
+};
+
+}  // namespace kota::ipc
@@ -1,15 +1,18 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "kota/ipc/codec.h"
 #include "kota/ipc/logger.h"
+#include "kota/ipc/metrics.h"
 #include "kota/ipc/transport.h"
 #include "kota/async/async.h"
 #include "kota/codec/detail/raw_value.h"
@@ -67,6 +70,41 @@ struct request_options {
     std::optional<std::chrono::milliseconds> timeout = std::nullopt;
 };
 
+/// Opt-in batching of outgoing messages. While a transport write is in flight, messages keep
+/// queueing; the next flush drains them (up to these limits) into one Transport::write_messages.
+struct write_coalescing_options {
+    /// Maximum number of messages folded into one flush.
+    std::size_t max_messages = 256;
+
+    /// Maximum payload bytes per flush. A single message larger than this is sent on its own.
+    std::size_t max_bytes = 1024 * 1024;
+
+    /// Send each flush of two or more messages as one JSON-RPC batch frame rather than as
+    /// separate frames. Only enable this when the other side is known to accept batches;
+    /// codecs without batch support ignore it.
+    bool batch_frames = false;
+
+    /// Called after each successful flush with the message count and payload bytes it carried.
+    std::function<void(std::size_t messages, std::size_t bytes)> on_flush;
+};
+
+/// Limits on the outgoing queue. Once either limit is reached, requests and handler responses
+/// wait for the write loop to drain the queue before they are enqueued; that wait still honours
+/// the request's timeout and cancellation token. Droppable notifications are discarded. All
+/// other notifications are still queued, because send_notification cannot wait; callers that
+/// want backpressure can co_await wait_for_outgoing_space() first.
+struct outgoing_queue_limits {
+    /// Maximum payload bytes waiting or in flight; 0 disables the byte limit.
+    std::size_t max_bytes = 0;
+
+    /// Maximum queued messages; 0 disables the count limit.
+    std::size_t max_messages = 0;
+
+    /// Returns true for notification methods that may be dropped while the queue is full,
+    /// e.g. `$/progress` or `window/logMessage`.
+    std::function<bool(std::string_view method)> droppable;
+};
+
 template <typename Codec>
 class Peer {
 public:
@@ -92,6 +130,33 @@ public:
 
     void set_logger(LogCallback callback, LogLevel min_level = LogLevel::info);
 
+    /// Enable write coalescing for outgoing messages; pass std::nullopt to disable it.
+    void set_write_coalescing(std::optional<write_coalescing_options> options);
+
+    /// Start or stop collecting per-method metrics for inbound requests and notifications.
+    /// Counters live on the peer's loop and are updated without locks or formatting; methods
+    /// without a registered handler are not tracked.
+    void enable_metrics(bool enabled = true);
+
+    /// Copy of the metrics collected so far, one entry per method in first-seen order.
+    std::vector<method_metrics> metrics_snapshot() const;
+
+    /// Size of the thread pool that runs on_worker_request() handlers, 4 by default. The pool
+    /// starts with the first such request, so this has no effect after that.
+    void set_worker_threads(std::size_t threads);
+
+    /// Bound the outgoing queue; pass std::nullopt to make it unbounded again.
+    void set_outgoing_limits(std::optional<outgoing_queue_limits> limits);
+
+    /// Resolves once the outgoing queue is below its limits, or the peer is closed.
+    task<> wait_for_outgoing_space();
+
+    /// Payload bytes currently queued or being written.
+    std::size_t outgoing_queue_bytes() const noexcept;
+
+    /// Number of droppable notifications discarded because the queue was full.
+    std::size_t dropped_notifications() const noexcept;
+
     template <typename Params>
     RequestResult<Params> send_request(const Params& params, request_options opts = {});
 
@@ -135,6 +200,50 @@ public:
     template <typename Tag, typename Callback>
     void on_notification(Callback&& callback);
 
+    /// Register a synchronous request handler that runs on this peer's worker thread pool
+    /// instead of its event loop, so CPU-heavy work does not stall reads, cancellations and
+    /// other requests. The pool is not libuv's shared one: that also serves file-system
+    /// requests for the whole process, and a few long handlers there would starve them. At
+    /// most set_worker_threads() handlers run at once; the rest wait their turn, still
+    /// cancellable. The callback has the shape
+    /// `Result<ResultT>(const Params&, const cancellation_token&)`. It may run concurrently
+    /// with itself and must not touch the peer. Params are decoded and the result is encoded
+    /// on the event loop. `$/cancelRequest` and close() cancel the token; a running handler
+    /// cannot be interrupted, so it should poll the token and return early.
+    template <typename Callback>
+    void on_worker_request(Callback&& callback);
+
+    template <typename Callback>
+    void on_worker_request(std::string_view method, Callback&& callback);
+
+    template <typename Tag, typename Callback>
+    void on_worker_request(Callback&& callback);
+
+    /// Let a newer inbound message for `method` supersede older ones that are still queued
+    /// and not yet dispatched. `key` maps the decoded params to a supersession key, such as
+    /// the document URI; returning std::nullopt exempts that message. A superseded
+    /// notification is dropped. A superseded request gets a RequestCancelled response and
+    /// its handler never runs. Only messages that get a key are held back, until the next loop
+    /// iteration, so that a burst read together can be compared. Everything else is dispatched
+    /// at once, after any held-back messages that arrived before it.
+    template <typename Params, typename KeyFn>
+    void supersede_queued(std::string_view method, KeyFn&& key);
+
+    template <typename Params, typename KeyFn>
+    void supersede_queued(KeyFn&& key);
+
+    /// Like supersede_queued(), but a newer notification absorbs the older queued one instead
+    /// of dropping it. `merge` has the shape `void(Params& older, const Params& newer)` and
+    /// folds `newer` into `older`; the result is dispatched in the newer one's place. A typical
+    /// use is joining the content changes of consecutive didChange notifications for one
+    /// document. Requests matched by the rule are superseded as usual. If either params fail
+    /// to decode, both notifications are dispatched unchanged.
+    template <typename Params, typename KeyFn, typename MergeFn>
+    void coalesce_queued(std::string_view method, KeyFn&& key, MergeFn&& merge);
+
+    template <typename Params, typename KeyFn, typename MergeFn>
+    void coalesce_queued(KeyFn&& key, MergeFn&& merge);
+
 private:
     template <typename Params, typename Callback>
     void bind_request_callback(std::string_view method, Callback&& callback);
@@ -142,6 +251,10 @@ private:
     template <typename Params, typename Callback>
     void bind_notification_callback(std::string_view method, Callback&& callback);
 
+    template <typename Params, typename Callback>
+    void bind_worker_request_callback(std::string_view method, Callback&& callback);
+
+    // Resolves to the fully encoded success response for the request.
     using RequestCallback = std::function<
         task<std::string, Error>(const protocol::RequestID&, std::string_view, cancellation_token)>;
     using NotificationCallback = std::function<void(std::string_view)>;
@@ -150,11 +263,24 @@ private:
 
     void register_notification_callback(std::string_view method, NotificationCallback callback);
 
-    task<std::string, Error> send_request_impl(std::string_view method,
-                                               std::string params,
-                                               request_options opts);
+    // Maps raw params to a supersession key; std::nullopt means "never superseded".
+    using SupersessionKey = std::function<std::optional<std::string>(std::string_view)>;
+
+    // Maps the raw params of an older and a newer notification to the encoded notification
+    // that replaces both.
+    using SupersessionMerge =
+        std::function<Result<std::string>(std::string_view older, std::string_view newer)>;
+
+    void register_supersession_rule(std::string_view method,
+                                    SupersessionKey key,
+                                    SupersessionMerge merge);
+
+    // Encodes the whole request message once its id has been assigned.
+    using RequestEncoder = std::function<Result<std::string>(const protocol::RequestID&)>;
+
+    task<std::string, Error> send_request_impl(RequestEncoder encode, request_options opts);
 
-    Result<void> send_notification_impl(std::string_view method, std::string params);
+    Result<void> send_notification_impl(Result<std::string> encoded);
 
     struct Self;
     std::unique_ptr<Self> self;
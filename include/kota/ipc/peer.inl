@@ -4,12 +4,14 @@
 #include "kota/ipc/peer.h"
 #endif
 
+#include <algorithm>
 #include <deque>
 #include <format>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -18,6 +20,9 @@
 #include <utility>
 #include <vector>
 
+#include "kota/ipc/method_table.h"
+#include "kota/ipc/metrics.h"
+#include "kota/ipc/request_table.h"
 #include "kota/support/function_traits.h"
 
 // Lazy log macro: level check happens before std::format is evaluated.
@@ -62,6 +67,13 @@ using notification_callback_params_t =
 template <typename Callback>
 using notification_callback_return_t = callable_return_t<std::remove_cvref_t<Callback>>;
 
+template <typename Callback>
+using worker_callback_params_t =
+    std::remove_cvref_t<std::tuple_element_t<0, request_callback_args_t<Callback>>>;
+
+template <typename Callback>
+using worker_callback_result_t = typename request_callback_return_t<Callback>::value_type;
+
 template <typename Callback, typename PeerT>
 consteval void validate_request_callback_signature() {
     using Args = request_callback_args_t<Callback>;
@@ -81,14 +93,18 @@ consteval void validate_notification_callback_signature() {
     static_assert(std::is_same_v<Ret, void>, "notification callback should return void");
 }
 
-inline task<> cancel_after_timeout(std::chrono::milliseconds timeout,
-                                   std::shared_ptr<cancellation_source> timeout_source,
-                                   cancellation_token stop_token,
-                                   event_loop& loop) {
-    auto result = co_await with_token(sleep(timeout, loop), stop_token);
-    if(result.has_value()) {
-        timeout_source->cancel();
-    }
+template <typename Callback>
+consteval void validate_worker_callback_signature() {
+    using Args = request_callback_args_t<Callback>;
+    static_assert(std::tuple_size_v<Args> == 2, "worker callback should have two parameters");
+
+    using Token = std::remove_cvref_t<std::tuple_element_t<1, Args>>;
+    static_assert(std::is_same_v<Token, cancellation_token>,
+                  "worker callback second parameter should be cancellation_token");
+
+    using Ret = request_callback_return_t<Callback>;
+    static_assert(std::is_same_v<Ret, Result<worker_callback_result_t<Callback>>>,
+                  "worker callback should return Result<ResultT>");
 }
 
 }  // namespace detail
@@ -99,9 +115,54 @@ inline task<> cancel_after_timeout(std::chrono::milliseconds timeout,
 
 template <typename CodecT>
 struct Peer<CodecT>::Self {
+    struct PendingRegistration;
+
+    // Table-owned and recycled across requests, so `ready` outlives the waiter's frame.
     struct PendingRequest {
         event ready;
         std::optional<Result<std::string>> response;
+        PendingRegistration* registration = nullptr;
+    };
+
+    // Lives in the requesting coroutine's frame and releases the table entry however that
+    // coroutine ends, including being destroyed while it waits.
+    struct PendingRegistration {
+        Self* owner;
+        std::int64_t id;
+
+        PendingRegistration(Self* owner, std::int64_t id) : owner(owner), id(id) {}
+
+        PendingRegistration(const PendingRegistration&) = delete;
+        PendingRegistration& operator=(const PendingRegistration&) = delete;
+
+        ~PendingRegistration() {
+            if(owner == nullptr) {
+                return;
+            }
+            if(auto* pending = owner->pending_requests.find(id)) {
+                pending->registration = nullptr;
+            }
+            owner->pending_requests.erase(id);
+        }
+    };
+
+    // Replies owed to one incoming batch. They are held until the last one is in and then
+    // sent together as a single batch frame.
+    struct BatchReplies {
+        std::vector<std::string> replies;
+        // Requests and invalid elements that have not been answered yet.
+        std::size_t pending = 0;
+    };
+
+    // An inbound message parked until the next dispatch pass. `method_storage` is boxed so
+    // the method view it backs survives moving the entry out of the queue.
+    struct QueuedMessage {
+        IncomingMessage message;
+        std::unique_ptr<std::string> method_storage;
+        std::string key;
+        bool superseded = false;
+        std::chrono::steady_clock::time_point received;
+        std::shared_ptr<BatchReplies> batch;
     };
 
     event_loop& loop;
@@ -109,33 +170,131 @@ struct Peer<CodecT>::Self {
     CodecT codec;
 
     std::deque<std::string> outgoing_queue;
-    std::int64_t next_request_id = 1;
 
-    std::unordered_map<std::string, RequestCallback> request_callbacks;
-    std::unordered_map<std::string, NotificationCallback> notification_callbacks;
+    detail::method_table<RequestCallback> request_callbacks;
+    detail::method_table<NotificationCallback> notification_callbacks;
+    struct SupersessionRule {
+        SupersessionKey key;
+        // Empty for plain supersession.
+        SupersessionMerge merge;
+    };
+
+    detail::method_table<SupersessionRule> supersession_rules;
+
+    std::deque<QueuedMessage> inbound_queue;
+    bool inbound_drain_scheduled = false;
+
+    // The batch that the message being dispatched right now arrived in, if any.
+    std::shared_ptr<BatchReplies> current_batch;
 
-    std::unordered_map<protocol::RequestID, std::shared_ptr<PendingRequest>> pending_requests;
+    // Per-method counters, only touched on the loop thread. The deque keeps entries at stable
+    // addresses so running requests can hold on to theirs.
+    bool metrics_enabled = false;
+    std::deque<method_metrics> metrics;
+    detail::method_table<method_metrics*> metrics_by_method;
+
+    // Runs on_worker_request handlers; started on first use.
+    std::size_t worker_threads = 4;
+    std::unique_ptr<thread_pool> workers;
+
+    detail::request_table<PendingRequest> pending_requests;
     std::unordered_map<protocol::RequestID, std::shared_ptr<cancellation_source>> incoming_requests;
 
     bool running = false;
     bool closed = false;
     event write_event;
 
+    std::optional<write_coalescing_options> coalescing;
+    std::vector<std::string> write_batch;
+
+    std::optional<outgoing_queue_limits> limits;
+    // Bytes queued or handed to the transport but not yet written.
+    std::size_t outgoing_bytes = 0;
+    std::size_t dropped = 0;
+    event space_event;
+
     LogCallback logger;
     LogLevel min_level = LogLevel::info;
 
     explicit Self(event_loop& external_loop, CodecT codec_arg) :
         loop(external_loop), codec(std::move(codec_arg)) {}
 
+    ~Self() {
+        // Requests still waiting must not touch the table once it is gone.
+        pending_requests.for_each([](PendingRequest& pending) {
+            if(pending.registration != nullptr) {
+                pending.registration->owner = nullptr;
+            }
+        });
+    }
+
     void enqueue_outgoing(std::string payload) {
         if(closed) {
             return;
         }
         ET_IPC_LOG(this, LogLevel::trace, "send: {}", payload);
+        outgoing_bytes += payload.size();
         outgoing_queue.push_back(std::move(payload));
         write_event.set();
     }
 
+    bool outgoing_full() const noexcept {
+        if(!limits) {
+            return false;
+        }
+        return (limits->max_bytes != 0 && outgoing_bytes >= limits->max_bytes) ||
+               (limits->max_messages != 0 && outgoing_queue.size() >= limits->max_messages);
+    }
+
+    task<> wait_for_space() {
+        while(outgoing_full() && !closed) {
+            space_event.reset();
+            co_await space_event.wait();
+        }
+    }
+
+    // Awaits `work` unless one of the given tokens fires first; returns whether it finished.
+    static task<bool> wait_unless_cancelled(task<> work,
+                                            std::optional<cancellation_token> first,
+                                            std::optional<cancellation_token> second) {
+        outcome<void, void, cancellation> result = outcome_value();
+        if(first && second) {
+            result = co_await with_token(std::move(work), *first, *second);
+        } else if(first) {
+            result = co_await with_token(std::move(work), *first);
+        } else if(second) {
+            result = co_await with_token(std::move(work), *second);
+        } else {
+            co_await std::move(work);
+        }
+        co_return result.has_value();
+    }
+
+    void release_outgoing(std::size_t bytes) {
+        outgoing_bytes -= std::min(bytes, outgoing_bytes);
+        if(!outgoing_full()) {
+            space_event.set();
+        }
+    }
+
+    void discard_outgoing() {
+        outgoing_queue.clear();
+        outgoing_bytes = 0;
+        space_event.set();
+    }
+
+    bool drop_notification(std::string_view method) {
+        if(!limits || !limits->droppable || !outgoing_full() || !limits->droppable(method)) {
+            return false;
+        }
+        ++dropped;
+        ET_IPC_LOG(this,
+                   LogLevel::debug,
+                   "outgoing queue full, dropped notification: {}",
+                   method);
+        return true;
+    }
+
     task<> write_loop() {
         while(true) {
             if(outgoing_queue.empty()) {
@@ -147,20 +306,18 @@ struct Peer<CodecT>::Self {
                 continue;
             }
 
-            auto payload = std::move(outgoing_queue.front());
-            outgoing_queue.pop_front();
-
             if(!transport) {
                 break;
             }
 
-            auto written = co_await transport->write_message(payload);
+            auto written = coalescing ? co_await flush_batch()
+                                      : co_await write_front();
             if(!written) {
                 ET_IPC_LOG(this,
                            LogLevel::error,
                            "transport write failed: {}",
                            written.error().message);
-                outgoing_queue.clear();
+                discard_outgoing();
                 fail_pending_requests(written.error().message);
                 transport->close();
                 break;
@@ -168,25 +325,117 @@ struct Peer<CodecT>::Self {
         }
     }
 
-    void send_error(const protocol::RequestID& id, const Error& error) {
+    task<void, Error> write_front() {
+        auto payload = std::move(outgoing_queue.front());
+        outgoing_queue.pop_front();
+        co_await transport->write_message(payload).or_fail();
+        release_outgoing(payload.size());
+    }
+
+    task<void, Error> flush_batch() {
+        write_batch.clear();
+        std::size_t bytes = 0;
+        while(!outgoing_queue.empty() && write_batch.size() < coalescing->max_messages) {
+            auto size = outgoing_queue.front().size();
+            if(!write_batch.empty() && bytes + size > coalescing->max_bytes) {
+                break;
+            }
+            bytes += size;
+            write_batch.push_back(std::move(outgoing_queue.front()));
+            outgoing_queue.pop_front();
+        }
+
+        const auto count = write_batch.size();
+        bool framed = false;
+        if constexpr(requires { codec.encode_batch(std::span<const std::string>(write_batch)); }) {
+            if(coalescing->batch_frames && count > 1) {
+                auto batch = codec.encode_batch(write_batch);
+                co_await transport->write_message(batch).or_fail();
+                framed = true;
+            }
+        }
+        if(!framed) {
+            co_await transport->write_messages(write_batch).or_fail();
+        }
+        release_outgoing(bytes);
+        ET_IPC_LOG(this, LogLevel::trace, "flushed {} message(s), {} byte(s)", count, bytes);
+        if(coalescing && coalescing->on_flush) {
+            coalescing->on_flush(count, bytes);
+        }
+    }
+
+    // Returns the encoded size of the response, or 0 if it could not be encoded.
+    std::size_t send_error(const protocol::RequestID& id, const Error& error) {
+        return send_error(id, error, current_batch);
+    }
+
+    std::size_t send_error(const protocol::RequestID& id,
+                           const Error& error,
+                           const std::shared_ptr<BatchReplies>& batch) {
         ET_IPC_LOG(this, LogLevel::error, "error response: {}", error.message);
         auto response = codec.encode_error_response(id, error);
-        if(response) {
-            enqueue_outgoing(std::move(*response));
+        if(!response) {
+            send_reply({}, batch);
+            return 0;
         }
+        return send_reply(std::move(*response), batch);
+    }
+
+    // Queues a reply, or holds it in `batch` until every reply that batch owes is in and then
+    // queues them all as one batch frame. An empty `reply` only counts as answered. Returns
+    // the reply's size.
+    std::size_t send_reply(std::string reply, const std::shared_ptr<BatchReplies>& batch) {
+        const auto size = reply.size();
+        if(!batch) {
+            if(size != 0) {
+                enqueue_outgoing(std::move(reply));
+            }
+            return size;
+        }
+
+        if(size != 0) {
+            batch->replies.push_back(std::move(reply));
+        }
+        if(--batch->pending != 0 || batch->replies.empty()) {
+            return size;
+        }
+        if constexpr(requires { codec.encode_batch(std::span<const std::string>()); }) {
+            enqueue_outgoing(codec.encode_batch(batch->replies));
+        }
+        return size;
+    }
+
+    // Metrics slot for a method that has a handler, or nullptr while metrics are off.
+    method_metrics* metrics_for(std::string_view method) {
+        if(!metrics_enabled) {
+            return nullptr;
+        }
+        if(auto* found = metrics_by_method.find(method)) {
+            return *found;
+        }
+        auto& slot = metrics.emplace_back();
+        slot.method = std::string(method);
+        metrics_by_method.insert_or_assign(method, &slot);
+        return &slot;
+    }
+
+    std::chrono::steady_clock::time_point metrics_now() const {
+        return metrics_enabled ? std::chrono::steady_clock::now()
+                               : std::chrono::steady_clock::time_point{};
     }
 
     void complete_pending_request(const protocol::RequestID& id, Result<std::string>&& response) {
-        auto it = pending_requests.find(id);
-        if(it == pending_requests.end()) {
+        // Only integer ids are ever issued by this peer.
+        const auto* number = std::get_if<std::int64_t>(&id);
+        auto* pending = number ? pending_requests.find(*number) : nullptr;
+        if(pending == nullptr || pending->response) {
             ET_IPC_LOG(this, LogLevel::warn, "orphan response for id={}", id);
             return;
         }
 
         ET_IPC_LOG(this, LogLevel::debug, "response received for id={}", id);
 
-        auto pending = std::move(it->second);
-        pending_requests.erase(it);
+        // The waiter releases the entry when it resumes.
         pending->response = std::move(response);
         pending->ready.set();
     }
@@ -202,21 +451,26 @@ struct Peer<CodecT>::Self {
                    pending_requests.size(),
                    message);
 
-        auto values = pending_requests | std::views::values;
-        std::vector<std::shared_ptr<PendingRequest>> pending(values.begin(), values.end());
-        pending_requests.clear();
-
-        for(auto& state: pending) {
-            state->response = outcome_error(Error(message));
-            state->ready.set();
+        // Setting an event resumes its waiter, which releases its own entry, so walk a copy
+        // of the ids rather than the table.
+        for(auto id: pending_requests.ids()) {
+            auto* pending = pending_requests.find(id);
+            if(pending == nullptr || pending->response) {
+                continue;
+            }
+            pending->response = outcome_error(Error(message));
+            pending->ready.set();
         }
     }
 
-    void dispatch_notification(const std::string& method, std::string_view params) {
+    void dispatch_notification(const IncomingNotification& notification,
+                               std::chrono::steady_clock::time_point received) {
+        const auto& method = notification.method;
+        const auto& params = notification.params;
         ET_IPC_LOG(this, LogLevel::debug, "notification: {}", method);
 
         if(method == "$/cancelRequest") {
-            auto parsed = codec.template deserialize_value<protocol::CancelRequestParams>(params);
+            auto parsed = codec.template deserialize_params<protocol::CancelRequestParams>(params);
             if(parsed) {
                 auto it = incoming_requests.find(parsed->id);
                 if(it != incoming_requests.end() && it->second) {
@@ -227,17 +481,29 @@ struct Peer<CodecT>::Self {
             return;
         }
 
-        if(auto it = notification_callbacks.find(method); it != notification_callbacks.end()) {
-            it->second(params);
+        if(auto* callback = notification_callbacks.find(method)) {
+            auto* stats = metrics_for(method);
+            if(stats == nullptr) {
+                (*callback)(params);
+                return;
+            }
+
+            const auto started = std::chrono::steady_clock::now();
+            stats->notifications += 1;
+            stats->bytes_in += notification.size;
+            stats->queue_wait.record(started - received);
+            (*callback)(params);
+            stats->handler_latency.record(std::chrono::steady_clock::now() - started);
         } else {
             ET_IPC_LOG(this, LogLevel::warn, "unhandled notification: {}", method);
         }
     }
 
-    void dispatch_request(const std::string& method,
-                          const protocol::RequestID& id,
-                          std::string_view params,
+    void dispatch_request(IncomingRequest& request,
+                          std::chrono::steady_clock::time_point received,
                           task_group<>& request_group) {
+        const auto& method = request.method;
+        const auto& id = request.id;
         ET_IPC_LOG(this, LogLevel::debug, "request: {} id={}", method, id);
 
         if(incoming_requests.contains(id)) {
@@ -245,56 +511,282 @@ struct Peer<CodecT>::Self {
             return;
         }
 
-        auto it = request_callbacks.find(method);
-        if(it == request_callbacks.end()) {
+        auto* registered = request_callbacks.find(method);
+        if(registered == nullptr) {
             send_error(id,
-                       Error(protocol::ErrorCode::MethodNotFound, "method not found: " + method));
+                       Error(protocol::ErrorCode::MethodNotFound,
+                             std::format("method not found: {}", method)));
             return;
         }
 
-        auto callback = it->second;
+        auto* stats = metrics_for(method);
+        if(stats) {
+            stats->requests += 1;
+            stats->in_flight += 1;
+            stats->bytes_in += request.size;
+            stats->queue_wait.record(std::chrono::steady_clock::now() - received);
+        }
+
+        auto callback = *registered;
         auto cancel_source = std::make_shared<cancellation_source>();
         incoming_requests.insert_or_assign(id, cancel_source);
-        request_group.spawn(
-            run_request(id, std::move(callback), std::string(params), cancel_source->token()));
+        request_group.spawn(run_request(id,
+                                        std::move(callback),
+                                        request.params,
+                                        std::move(request.payload),
+                                        cancel_source->token(),
+                                        stats,
+                                        current_batch));
     }
 
+    // `payload` owns the buffer `params` points into and keeps it alive while the handler runs.
     task<> run_request(protocol::RequestID id,
                        RequestCallback callback,
-                       std::string params,
-                       cancellation_token token) {
+                       std::string_view params,
+                       std::shared_ptr<const MessageBuffer> payload,
+                       cancellation_token token,
+                       method_metrics* stats,
+                       std::shared_ptr<BatchReplies> batch) {
+        const auto started = stats ? std::chrono::steady_clock::now()
+                                   : std::chrono::steady_clock::time_point{};
         auto guarded_result = co_await with_token(callback(id, params, token), token);
+
+        if(stats) {
+            stats->in_flight -= 1;
+            stats->handler_latency.record(std::chrono::steady_clock::now() - started);
+        }
+
+        // The request stays registered while its reply waits for queue space, so a
+        // $/cancelRequest arriving meanwhile still cancels it.
+        bool cancelled = guarded_result.is_cancelled();
+        if(!cancelled && guarded_result.has_value()) {
+            cancelled = !co_await wait_unless_cancelled(wait_for_space(), token, std::nullopt);
+        }
         incoming_requests.erase(id);
 
-        if(guarded_result.is_cancelled()) {
-            send_error(id, Error(protocol::ErrorCode::RequestCancelled, "request cancelled"));
+        if(cancelled) {
+            auto bytes = send_error(id,
+                                    Error(protocol::ErrorCode::RequestCancelled, "request cancelled"),
+                                    batch);
+            if(stats) {
+                stats->cancelled += 1;
+                stats->bytes_out += bytes;
+            }
             co_return;
         }
 
         if(guarded_result.has_error()) {
-            send_error(id, guarded_result.error());
+            auto bytes = send_error(id, guarded_result.error(), batch);
+            if(stats) {
+                stats->failed += 1;
+                stats->bytes_out += bytes;
+            }
             co_return;
         }
 
-        auto response = codec.encode_success_response(id, *guarded_result);
-        if(!response) {
-            send_error(id, Error(protocol::ErrorCode::InternalError, response.error().message));
-            co_return;
+        auto bytes = send_reply(std::move(*guarded_result), batch);
+        if(stats) {
+            stats->bytes_out += bytes;
+        }
+    }
+
+    void dispatch_incoming_message(MessageBuffer payload, task_group<>& request_group) {
+        ET_IPC_LOG(this, LogLevel::trace, "recv: {}", payload.view());
+        const auto received = metrics_now();
+        auto shared = std::make_shared<const MessageBuffer>(std::move(payload));
+
+        if constexpr(requires { CodecT::is_batch(std::string_view{}); }) {
+            if(CodecT::is_batch(shared->view())) {
+                // Every element goes through the same routing in one pass. The replies go back
+                // as one batch frame once all requests in it are answered; notifications get
+                // none, so a batch of only notifications gets no reply at all.
+                std::vector<IncomingMessage> batch;
+                if(!codec.parse_batch(std::move(shared), batch)) {
+                    // Not a usable batch; its single error is answered on its own.
+                    route_incoming(std::move(batch.front()), received, request_group);
+                    return;
+                }
+
+                auto replies = std::make_shared<BatchReplies>();
+                for(const auto& msg: batch) {
+                    if(std::holds_alternative<IncomingRequest>(msg) ||
+                       std::holds_alternative<IncomingParseError>(msg)) {
+                        replies->pending += 1;
+                    }
+                }
+                if(replies->pending == 0) {
+                    replies.reset();
+                }
+
+                current_batch = replies;
+                for(auto& msg: batch) {
+                    route_incoming(std::move(msg), received, request_group);
+                }
+                current_batch.reset();
+                return;
+            }
+        }
+
+        route_incoming(codec.parse_message(std::move(shared)), received, request_group);
+    }
+
+    void route_incoming(IncomingMessage msg,
+                        std::chrono::steady_clock::time_point received,
+                        task_group<>& request_group) {
+        auto* request = std::get_if<IncomingRequest>(&msg);
+        auto* notification = std::get_if<IncomingNotification>(&msg);
+        if(request == nullptr && notification == nullptr) {
+            // Responses and parse errors carry no handler ordering, so they never wait.
+            dispatch_parsed(msg, received, request_group);
+            return;
+        }
+
+        const auto method = request ? request->method : notification->method;
+        auto* rule = supersession_rules.find(method);
+        std::optional<std::string> key;
+        if(rule != nullptr) {
+            key = rule->key(request ? request->params : notification->params);
+        }
+
+        if(!key) {
+            // Not subject to supersession: run it now, after anything queued before it, so
+            // handlers still see messages in arrival order.
+            drain_inbound_now(request_group);
+            dispatch_parsed(msg, received, request_group);
+            return;
+        }
+
+        enqueue_inbound(std::move(msg), std::move(*key), *rule, received);
+        if(!inbound_drain_scheduled) {
+            inbound_drain_scheduled = true;
+            request_group.spawn(drain_inbound(request_group));
+        }
+    }
+
+    // Copies a method name that was unescaped into codec scratch, which the next parse reuses.
+    static void pin_method(QueuedMessage& entry) {
+        auto* request = std::get_if<IncomingRequest>(&entry.message);
+        auto* notification = std::get_if<IncomingNotification>(&entry.message);
+        auto& method = request ? request->method : notification->method;
+        const auto& payload = request ? request->payload : notification->payload;
+        const auto* begin = payload ? payload->data() : nullptr;
+        if(!payload || std::less<>{}(method.data(), begin) ||
+           !std::less<>{}(method.data(), begin + payload->size())) {
+            entry.method_storage = std::make_unique<std::string>(method);
+            method = *entry.method_storage;
+        }
+    }
+
+    void enqueue_inbound(IncomingMessage msg,
+                         std::string key,
+                         const SupersessionRule& rule,
+                         std::chrono::steady_clock::time_point received) {
+        auto& entry = inbound_queue.emplace_back();
+        entry.message = std::move(msg);
+        entry.key = std::move(key);
+        entry.received = received;
+        entry.batch = current_batch;
+        pin_method(entry);
+
+        for(auto& queued: inbound_queue) {
+            if(&queued == &entry) {
+                break;
+            }
+            if(queued.superseded || queued.key != entry.key ||
+               queued.message.index() != entry.message.index()) {
+                continue;
+            }
+
+            if(auto* older = std::get_if<IncomingRequest>(&queued.message)) {
+                auto& newer = std::get<IncomingRequest>(entry.message);
+                if(older->method == newer.method) {
+                    queued.superseded = true;
+                    ET_IPC_LOG(this,
+                               LogLevel::debug,
+                               "request superseded: {} id={}",
+                               newer.method,
+                               older->id);
+                    send_error(older->id,
+                               Error(protocol::ErrorCode::RequestCancelled, "request superseded"),
+                               queued.batch);
+                }
+            } else if(auto* older = std::get_if<IncomingNotification>(&queued.message)) {
+                auto& newer = std::get<IncomingNotification>(entry.message);
+                if(older->method == newer.method) {
+                    queued.superseded = merge_notification(rule, *older, entry);
+                }
+            }
+        }
+    }
+
+    // Retires `older` in favour of the newer queued `entry`. With a merge rule, `entry` is
+    // replaced by both merged into one; if that fails, both are kept and this returns false.
+    bool merge_notification(const SupersessionRule& rule,
+                            const IncomingNotification& older,
+                            QueuedMessage& entry) {
+        auto& newer = std::get<IncomingNotification>(entry.message);
+        if(!rule.merge) {
+            ET_IPC_LOG(this, LogLevel::debug, "notification superseded: {}", newer.method);
+            return true;
+        }
+
+        auto merged = rule.merge(older.params, newer.params);
+        if(!merged) {
+            ET_IPC_LOG(this,
+                       LogLevel::warn,
+                       "notification not coalesced: {}: {}",
+                       newer.method,
+                       merged.error().message);
+            return false;
         }
 
-        enqueue_outgoing(std::move(*response));
+        auto message = codec.parse_message(std::string_view(*merged));
+        if(!std::holds_alternative<IncomingNotification>(message)) {
+            return false;
+        }
+        entry.message = std::move(message);
+        entry.method_storage.reset();
+        pin_method(entry);
+        ET_IPC_LOG(this,
+                   LogLevel::debug,
+                   "notification coalesced: {}",
+                   std::get<IncomingNotification>(entry.message).method);
+        return true;
+    }
+
+    task<> drain_inbound(task_group<>& request_group) {
+        // Yield one loop iteration so the read loop pulls in everything the transport already
+        // has buffered; supersession only sees messages that are queued together.
+        co_await sleep(0, loop);
+        inbound_drain_scheduled = false;
+        drain_inbound_now(request_group);
     }
 
-    void dispatch_incoming_message(std::string_view payload, task_group<>& request_group) {
-        ET_IPC_LOG(this, LogLevel::trace, "recv: {}", payload);
-        auto msg = codec.parse_message(payload);
+    void drain_inbound_now(task_group<>& request_group) {
+        // Each entry leaves the queue before it is dispatched: a handler may call close(),
+        // which clears the queue, and nothing is dispatched after that.
+        auto arriving_batch = std::move(current_batch);
+        while(!inbound_queue.empty() && !closed) {
+            auto entry = std::move(inbound_queue.front());
+            inbound_queue.pop_front();
+            if(!entry.superseded) {
+                current_batch = std::move(entry.batch);
+                dispatch_parsed(entry.message, entry.received, request_group);
+            }
+        }
+        current_batch = std::move(arriving_batch);
+    }
+
+    void dispatch_parsed(IncomingMessage& msg,
+                         std::chrono::steady_clock::time_point received,
+                         task_group<>& request_group) {
         std::visit(
             [&](auto& m) {
                 using T = std::remove_cvref_t<decltype(m)>;
                 if constexpr(std::is_same_v<T, IncomingRequest>) {
-                    dispatch_request(m.method, m.id, m.params, request_group);
+                    dispatch_request(m, received, request_group);
                 } else if constexpr(std::is_same_v<T, IncomingNotification>) {
-                    dispatch_notification(m.method, m.params);
+                    dispatch_notification(m, received);
                 } else if constexpr(std::is_same_v<T, IncomingResponse>) {
                     complete_pending_request(m.id, Result<std::string>(std::move(m.result)));
                 } else if constexpr(std::is_same_v<T, IncomingErrorResponse>) {
@@ -338,7 +830,7 @@ task<> Peer<CodecT>::run() {
                 self->fail_pending_requests("transport closed");
                 break;
             }
-            self->dispatch_incoming_message(*payload, request_group);
+            self->dispatch_incoming_message(std::move(*payload), request_group);
         }
         ET_IPC_LOG(self.get(), LogLevel::info, "{}", "read loop ended");
     };
@@ -383,8 +875,9 @@ Result<void> Peer<CodecT>::close() {
     // Fail pending outgoing requests.
     self->fail_pending_requests("peer closed");
 
-    // Discard queued outgoing messages.
-    self->outgoing_queue.clear();
+    // Discard queued outgoing messages and undispatched inbound ones.
+    self->discard_outgoing();
+    self->inbound_queue.clear();
 
     // Wake write_loop so it exits.
     self->write_event.set();
@@ -408,35 +901,89 @@ void Peer<CodecT>::set_logger(LogCallback callback, LogLevel min_level) {
     self->min_level = min_level;
 }
 
+template <typename CodecT>
+void Peer<CodecT>::set_write_coalescing(std::optional<write_coalescing_options> options) {
+    self->coalescing = std::move(options);
+}
+
+template <typename CodecT>
+void Peer<CodecT>::enable_metrics(bool enabled) {
+    self->metrics_enabled = enabled;
+}
+
+template <typename CodecT>
+std::vector<method_metrics> Peer<CodecT>::metrics_snapshot() const {
+    return std::vector<method_metrics>(self->metrics.begin(), self->metrics.end());
+}
+
+template <typename CodecT>
+void Peer<CodecT>::set_worker_threads(std::size_t threads) {
+    self->worker_threads = threads;
+}
+
+template <typename CodecT>
+void Peer<CodecT>::set_outgoing_limits(std::optional<outgoing_queue_limits> limits) {
+    self->limits = std::move(limits);
+    if(!self->outgoing_full()) {
+        self->space_event.set();
+    }
+}
+
+template <typename CodecT>
+task<> Peer<CodecT>::wait_for_outgoing_space() {
+    co_await self->wait_for_space();
+}
+
+template <typename CodecT>
+std::size_t Peer<CodecT>::outgoing_queue_bytes() const noexcept {
+    return self->outgoing_bytes;
+}
+
+template <typename CodecT>
+std::size_t Peer<CodecT>::dropped_notifications() const noexcept {
+    return self->dropped;
+}
+
 template <typename CodecT>
 void Peer<CodecT>::register_request_callback(std::string_view method, RequestCallback callback) {
-    self->request_callbacks.insert_or_assign(std::string(method), std::move(callback));
+    self->request_callbacks.insert_or_assign(method, std::move(callback));
 }
 
 template <typename CodecT>
 void Peer<CodecT>::register_notification_callback(std::string_view method,
                                                   NotificationCallback callback) {
-    self->notification_callbacks.insert_or_assign(std::string(method), std::move(callback));
+    self->notification_callbacks.insert_or_assign(method, std::move(callback));
 }
 
 template <typename CodecT>
-task<std::string, Error> Peer<CodecT>::send_request_impl(std::string_view method,
-                                                         std::string params,
+void Peer<CodecT>::register_supersession_rule(std::string_view method,
+                                              SupersessionKey key,
+                                              SupersessionMerge merge) {
+    self->supersession_rules.insert_or_assign(
+        method,
+        typename Self::SupersessionRule{std::move(key), std::move(merge)});
+}
+
+template <typename CodecT>
+task<std::string, Error> Peer<CodecT>::send_request_impl(RequestEncoder encode,
                                                          request_options opts) {
-    std::shared_ptr<cancellation_source> timeout_source;
-    // Stops the timeout timer when this coroutine finishes (destructor calls cancel()).
-    std::optional<cancellation_source> timeout_stop;
+    std::optional<cancellation_source> timeout_source;
+    // Declared after the source so it is disarmed first when this coroutine finishes.
+    std::optional<deadline> timeout_deadline;
 
     if(opts.timeout.has_value()) {
         if(*opts.timeout <= std::chrono::milliseconds::zero()) {
             co_await fail(protocol::ErrorCode::RequestCancelled, "request timed out");
         }
 
-        timeout_source = std::make_shared<cancellation_source>();
-        timeout_stop.emplace();
+        timeout_source.emplace();
         if(self) {
-            self->loop.schedule(detail::cancel_after_timeout(
-                *opts.timeout, timeout_source, timeout_stop->token(), self->loop));
+            timeout_deadline.emplace(self->loop);
+            timeout_deadline->arm(*opts.timeout, [source = &*timeout_source] {
+                // cancel() resumes the waiter, which may finish and destroy the source.
+                auto keep_alive = source->token();
+                source->cancel();
+            });
         }
     }
 
@@ -448,37 +995,41 @@ task<std::string, Error> Peer<CodecT>::send_request_impl(std::string_view method
         co_await fail(protocol::ErrorCode::RequestCancelled, "request cancelled");
     }
 
-    protocol::RequestID request_id{self->next_request_id++};
+    std::optional<cancellation_token> timeout_token;
+    if(timeout_source) {
+        timeout_token = timeout_source->token();
+    }
 
-    auto pending = std::make_shared<typename Self::PendingRequest>();
-    self->pending_requests.insert_or_assign(request_id, pending);
+    if(self->outgoing_full()) {
+        if(!co_await Self::wait_unless_cancelled(self->wait_for_space(),
+                                                 opts.token,
+                                                 timeout_token)) {
+            if(opts.token && opts.token->cancelled()) {
+                co_await fail(protocol::ErrorCode::RequestCancelled, "request cancelled");
+            }
+            co_await fail(protocol::ErrorCode::RequestCancelled, "request timed out");
+        }
+        if(self->closed) {
+            co_await fail("transport is null");
+        }
+    }
+
+    auto [raw_id, pending] = self->pending_requests.insert();
+    typename Self::PendingRegistration registration(self.get(), raw_id);
+    pending.ready.reset();
+    pending.response.reset();
+    pending.registration = &registration;
+    protocol::RequestID request_id{raw_id};
 
-    auto request_encoded = self->codec.encode_request(request_id, method, params);
+    auto request_encoded = encode(request_id);
     if(!request_encoded) {
-        self->pending_requests.erase(request_id);
         co_await fail(request_encoded.error());
     }
 
     self->enqueue_outgoing(std::move(*request_encoded));
 
-    auto wait_pending = [](const std::shared_ptr<typename Self::PendingRequest>& state) -> task<> {
-        co_await state->ready.wait();
-    };
-    auto wait_task = wait_pending(pending);
-    outcome<void, void, cancellation> wait_result = outcome_value();
-    if(opts.token && timeout_source) {
-        wait_result =
-            co_await with_token(std::move(wait_task), *opts.token, timeout_source->token());
-    } else if(opts.token) {
-        wait_result = co_await with_token(std::move(wait_task), *opts.token);
-    } else if(timeout_source) {
-        wait_result = co_await with_token(std::move(wait_task), timeout_source->token());
-    } else {
-        co_await std::move(wait_task);
-    }
-    if(!wait_result.has_value()) {
-        if(auto it = self->pending_requests.find(request_id); it != self->pending_requests.end()) {
-            self->pending_requests.erase(it);
+    if(!co_await Self::wait_unless_cancelled(pending.ready.wait(), opts.token, timeout_token)) {
+        if(!pending.response) {
             auto cancel_params_serialized =
                 self->codec.serialize_value(protocol::CancelRequestParams{request_id});
             if(cancel_params_serialized) {
@@ -496,25 +1047,24 @@ task<std::string, Error> Peer<CodecT>::send_request_impl(std::string_view method
         co_await fail(protocol::ErrorCode::RequestCancelled, "request timed out");
     }
 
-    if(!pending->response.has_value()) {
+    if(!pending.response.has_value()) {
         co_await fail("request was not completed");
     }
 
-    co_return co_await or_fail(std::move(*pending->response));
+    co_return co_await or_fail(std::exchange(pending.response, std::nullopt).value());
 }
 
 template <typename CodecT>
-Result<void> Peer<CodecT>::send_notification_impl(std::string_view method, std::string params) {
+Result<void> Peer<CodecT>::send_notification_impl(Result<std::string> encoded) {
     if(!self || !self->transport || self->closed) {
         return outcome_error(Error("transport is null"));
     }
 
-    auto notification_encoded = self->codec.encode_notification(method, params);
-    if(!notification_encoded) {
-        return outcome_error(notification_encoded.error());
+    if(!encoded) {
+        return outcome_error(encoded.error());
     }
 
-    self->enqueue_outgoing(std::move(*notification_encoded));
+    self->enqueue_outgoing(std::move(*encoded));
     return {};
 }
 
@@ -529,10 +1079,10 @@ RequestResult<Params> Peer<CodecT>::send_request(const Params& params, request_o
                   "send_request(params) requires RequestTraits<Params>");
     using Traits = protocol::RequestTraits<Params>;
 
-    auto serialized_params = co_await or_fail(self->codec.serialize_value(params));
-    auto raw_result =
-        co_await send_request_impl(Traits::method, std::move(serialized_params), std::move(opts))
-            .or_fail();
+    auto encode = [this, &params](const protocol::RequestID& id) {
+        return self->codec.encode_request_value(id, Traits::method, params);
+    };
+    auto raw_result = co_await send_request_impl(std::move(encode), std::move(opts)).or_fail();
     co_return co_await or_fail(
         self->codec.template deserialize_value<typename Traits::Result>(raw_result));
 }
@@ -542,9 +1092,10 @@ template <typename ResultT, typename Params>
 task<ResultT, Error> Peer<CodecT>::send_request(std::string_view method,
                                                 const Params& params,
                                                 request_options opts) {
-    auto serialized_params = co_await or_fail(self->codec.serialize_value(params));
-    auto raw_result =
-        co_await send_request_impl(method, std::move(serialized_params), std::move(opts)).or_fail();
+    auto encode = [this, method, &params](const protocol::RequestID& id) {
+        return self->codec.encode_request_value(id, method, params);
+    };
+    auto raw_result = co_await send_request_impl(std::move(encode), std::move(opts)).or_fail();
     co_return co_await or_fail(self->codec.template deserialize_value<ResultT>(raw_result));
 }
 
@@ -555,21 +1106,19 @@ Result<void> Peer<CodecT>::send_notification(const Params& params) {
                   "send_notification(params) requires NotificationTraits<Params>");
     using Traits = protocol::NotificationTraits<Params>;
 
-    auto serialized_params = self->codec.serialize_value(params);
-    if(!serialized_params) {
-        return outcome_error(serialized_params.error());
+    if(self->drop_notification(Traits::method)) {
+        return {};
     }
-    return send_notification_impl(Traits::method, std::move(*serialized_params));
+    return send_notification_impl(self->codec.encode_notification_value(Traits::method, params));
 }
 
 template <typename CodecT>
 template <typename Params>
 Result<void> Peer<CodecT>::send_notification(std::string_view method, const Params& params) {
-    auto serialized_params = self->codec.serialize_value(params);
-    if(!serialized_params) {
-        return outcome_error(serialized_params.error());
+    if(self->drop_notification(method)) {
+        return {};
     }
-    return send_notification_impl(method, std::move(*serialized_params));
+    return send_notification_impl(self->codec.encode_notification_value(method, params));
 }
 
 template <typename CodecT>
@@ -630,10 +1179,10 @@ auto Peer<CodecT>::send_request(const typename protocol::RequestTraits<Tag>::Par
     -> task<typename protocol::RequestTraits<Tag>::Result, Error> {
     using Traits = protocol::RequestTraits<Tag>;
 
-    auto serialized_params = co_await or_fail(self->codec.serialize_value(params));
-    auto raw_result =
-        co_await send_request_impl(Traits::method, std::move(serialized_params), std::move(opts))
-            .or_fail();
+    auto encode = [this, &params](const protocol::RequestID& id) {
+        return self->codec.encode_request_value(id, Traits::method, params);
+    };
+    auto raw_result = co_await send_request_impl(std::move(encode), std::move(opts)).or_fail();
     co_return co_await or_fail(
         self->codec.template deserialize_value<typename Traits::Result>(raw_result));
 }
@@ -645,11 +1194,10 @@ Result<void> Peer<CodecT>::send_notification(
     const typename protocol::NotificationTraits<Tag>::Params& params) {
     using Traits = protocol::NotificationTraits<Tag>;
 
-    auto serialized_params = self->codec.serialize_value(params);
-    if(!serialized_params) {
-        return outcome_error(serialized_params.error());
+    if(self->drop_notification(Traits::method)) {
+        return {};
     }
-    return send_notification_impl(Traits::method, std::move(*serialized_params));
+    return send_notification_impl(self->codec.encode_notification_value(Traits::method, params));
 }
 
 template <typename CodecT>
@@ -684,6 +1232,119 @@ void Peer<CodecT>::on_notification(Callback&& callback) {
     bind_notification_callback<Params>(Traits::method, std::forward<Callback>(callback));
 }
 
+template <typename CodecT>
+template <typename Callback>
+void Peer<CodecT>::on_worker_request(Callback&& callback) {
+    detail::validate_worker_callback_signature<Callback>();
+
+    using Params = detail::worker_callback_params_t<Callback>;
+    static_assert(detail::has_request_traits_v<Params>,
+                  "on_worker_request(callback) requires RequestTraits<Params>");
+    static_assert(std::is_same_v<detail::worker_callback_result_t<Callback>,
+                                 typename protocol::RequestTraits<Params>::Result>,
+                  "worker callback should return Result<RequestTraits<Params>::Result>");
+
+    bind_worker_request_callback<Params>(protocol::RequestTraits<Params>::method,
+                                         std::forward<Callback>(callback));
+}
+
+template <typename CodecT>
+template <typename Callback>
+void Peer<CodecT>::on_worker_request(std::string_view method, Callback&& callback) {
+    detail::validate_worker_callback_signature<Callback>();
+
+    using Params = detail::worker_callback_params_t<Callback>;
+    bind_worker_request_callback<Params>(method, std::forward<Callback>(callback));
+}
+
+template <typename CodecT>
+template <typename Tag, typename Callback>
+void Peer<CodecT>::on_worker_request(Callback&& callback) {
+    static_assert(detail::has_tag_request_traits_v<Tag>,
+                  "on_worker_request<Tag> requires tag-based RequestTraits<Tag>");
+    detail::validate_worker_callback_signature<Callback>();
+
+    using Traits = protocol::RequestTraits<Tag>;
+    static_assert(std::is_same_v<detail::worker_callback_result_t<Callback>,
+                                 typename Traits::Result>,
+                  "worker callback should return Result<RequestTraits<Tag>::Result>");
+
+    bind_worker_request_callback<typename Traits::Params>(Traits::method,
+                                                          std::forward<Callback>(callback));
+}
+
+template <typename CodecT>
+template <typename Params, typename KeyFn>
+void Peer<CodecT>::supersede_queued(std::string_view method, KeyFn&& key) {
+    auto wrapped = [fn = std::forward<KeyFn>(key),
+                    peer = this](std::string_view params_raw) -> std::optional<std::string> {
+        auto parsed_params = peer->self->codec.template deserialize_params<Params>(params_raw);
+        if(!parsed_params) {
+            // Leave it to the handler to report the bad params.
+            return std::nullopt;
+        }
+        return std::invoke(fn, std::as_const(*parsed_params));
+    };
+
+    register_supersession_rule(method, std::move(wrapped), nullptr);
+}
+
+template <typename CodecT>
+template <typename Params, typename KeyFn>
+void Peer<CodecT>::supersede_queued(KeyFn&& key) {
+    if constexpr(detail::has_notification_traits_v<Params>) {
+        supersede_queued<Params>(protocol::NotificationTraits<Params>::method,
+                                 std::forward<KeyFn>(key));
+    } else {
+        static_assert(detail::has_request_traits_v<Params>,
+                      "supersede_queued<Params>(key) requires RequestTraits or NotificationTraits");
+        supersede_queued<Params>(protocol::RequestTraits<Params>::method,
+                                 std::forward<KeyFn>(key));
+    }
+}
+
+template <typename CodecT>
+template <typename Params, typename KeyFn, typename MergeFn>
+void Peer<CodecT>::coalesce_queued(std::string_view method, KeyFn&& key, MergeFn&& merge) {
+    auto key_of = [fn = std::forward<KeyFn>(key),
+                   peer = this](std::string_view params_raw) -> std::optional<std::string> {
+        auto parsed_params = peer->self->codec.template deserialize_params<Params>(params_raw);
+        if(!parsed_params) {
+            return std::nullopt;
+        }
+        return std::invoke(fn, std::as_const(*parsed_params));
+    };
+
+    auto merged = [fn = std::forward<MergeFn>(merge),
+                   method_name = std::string(method),
+                   peer = this](std::string_view older_raw,
+                                std::string_view newer_raw) -> Result<std::string> {
+        auto& codec = peer->self->codec;
+        auto older = codec.template deserialize_params<Params>(older_raw);
+        if(!older) {
+            return outcome_error(older.error());
+        }
+        auto newer = codec.template deserialize_params<Params>(newer_raw);
+        if(!newer) {
+            return outcome_error(newer.error());
+        }
+        std::invoke(fn, *older, std::as_const(*newer));
+        return codec.encode_notification_value(method_name, *older);
+    };
+
+    register_supersession_rule(method, std::move(key_of), std::move(merged));
+}
+
+template <typename CodecT>
+template <typename Params, typename KeyFn, typename MergeFn>
+void Peer<CodecT>::coalesce_queued(KeyFn&& key, MergeFn&& merge) {
+    static_assert(detail::has_notification_traits_v<Params>,
+                  "coalesce_queued<Params>(key, merge) requires NotificationTraits<Params>");
+    coalesce_queued<Params>(protocol::NotificationTraits<Params>::method,
+                            std::forward<KeyFn>(key),
+                            std::forward<MergeFn>(merge));
+}
+
 template <typename CodecT>
 template <typename Params, typename Callback>
 void Peer<CodecT>::bind_request_callback(std::string_view method, Callback&& callback) {
@@ -692,7 +1353,7 @@ void Peer<CodecT>::bind_request_callback(std::string_view method, Callback&& cal
                     peer = this](const protocol::RequestID& request_id,
                                  std::string_view params_raw,
                                  cancellation_token token) -> task<std::string, Error> {
-        auto parsed_params = peer->self->codec.template deserialize_value<Params>(
+        auto parsed_params = peer->self->codec.template deserialize_params<Params>(
             params_raw,
             protocol::ErrorCode::InvalidParams);
         if(!parsed_params) {
@@ -708,12 +1369,60 @@ void Peer<CodecT>::bind_request_callback(std::string_view method, Callback&& cal
         context.method = method_name;
 
         auto result = co_await std::invoke(cb, context, *parsed_params).or_fail();
-        auto serialized = peer->self->codec.serialize_value(result);
-        if(!serialized) {
-            co_await fail(Error(protocol::ErrorCode::InternalError, serialized.error().message));
+        auto response = peer->self->codec.encode_success_response_value(request_id, result);
+        if(!response) {
+            co_await fail(Error(protocol::ErrorCode::InternalError, response.error().message));
+        }
+
+        co_return std::move(*response);
+    };
+
+    register_request_callback(method, std::move(wrapped));
+}
+
+template <typename CodecT>
+template <typename Params, typename Callback>
+void Peer<CodecT>::bind_worker_request_callback(std::string_view method, Callback&& callback) {
+    using ResultT = detail::worker_callback_result_t<Callback>;
+
+    auto wrapped = [cb = std::forward<Callback>(callback),
+                    method_name = std::string(method),
+                    peer = this](const protocol::RequestID& request_id,
+                                 std::string_view params_raw,
+                                 cancellation_token token) -> task<std::string, Error> {
+        // The codec is loop-affine, so params are decoded here and only the handler hops.
+        auto parsed_params = peer->self->codec.template deserialize_params<Params>(
+            params_raw,
+            protocol::ErrorCode::InvalidParams);
+        if(!parsed_params) {
+            ET_IPC_LOG(peer->self.get(),
+                       LogLevel::warn,
+                       "request '{}' params deserialization failed: {}",
+                       method_name,
+                       parsed_params.error().message);
+            co_await fail(parsed_params.error());
+        }
+
+        auto& self = *peer->self;
+        if(!self.workers) {
+            self.workers = std::make_unique<thread_pool>(self.worker_threads);
+        }
+
+        // Everything the worker touches lives in this frame. Cancelling the queued work only
+        // completes once the worker has returned, so these references stay valid.
+        std::optional<Result<ResultT>> result;
+        auto work = [&] {
+            result.emplace(std::invoke(cb, std::as_const(*parsed_params), std::as_const(token)));
+        };
+        co_await self.workers->run(function<void()>(work), self.loop);
+
+        auto value = co_await or_fail(std::move(*result));
+        auto response = peer->self->codec.encode_success_response_value(request_id, value);
+        if(!response) {
+            co_await fail(Error(protocol::ErrorCode::InternalError, response.error().message));
         }
 
-        co_return std::move(*serialized);
+        co_return std::move(*response);
     };
 
     register_request_callback(method, std::move(wrapped));
@@ -724,7 +1433,7 @@ template <typename Params, typename Callback>
 void Peer<CodecT>::bind_notification_callback(std::string_view method, Callback&& callback) {
     auto wrapped = [cb = std::forward<Callback>(callback),
                     peer = this](std::string_view params_raw) {
-        auto parsed_params = peer->self->codec.template deserialize_value<Params>(params_raw);
+        auto parsed_params = peer->self->codec.template deserialize_params<Params>(params_raw);
         if(!parsed_params) {
             ET_IPC_LOG(peer->self.get(),
                        LogLevel::warn,
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <chrono>
-#include <cstdio>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -10,26 +11,47 @@
 
 namespace kota::ipc {
 
+struct recording_options {
+    /// Most bytes of raw records buffered or being written out; records that would exceed it
+    /// are dropped.
+    std::size_t max_buffered_bytes = 8 * 1024 * 1024;
+};
+
 /// Transport decorator that records client-to-server messages to a JSONL file.
 /// Each line is: {"ts":<ms_since_start>,"msg":"<escaped_json>"}
 /// The timestamp enables faithful replay pacing.
+///
+/// Recording never blocks the event loop on the disk: a record is appended to an in-memory
+/// buffer, and a background thread swaps that buffer out, escapes its records and writes
+/// them. When the disk falls behind by more than `max_buffered_bytes`, new records are
+/// dropped and counted instead.
 class RecordingTransport : public Transport {
 public:
     /// @param transport  The real transport to wrap.
     /// @param path       File path to write the recorded trace (.jsonl).
-    RecordingTransport(std::unique_ptr<Transport> transport, std::string path);
+    RecordingTransport(std::unique_ptr<Transport> transport,
+                       std::string path,
+                       recording_options options = {});
     ~RecordingTransport();
 
-    task<std::optional<std::string>> read_message() override;
+    task<std::optional<MessageBuffer>> read_message() override;
     task<void, Error> write_message(std::string_view payload) override;
+    task<void, Error> write_messages(std::span<const std::string> payloads) override;
     Result<void> close_output() override;
+
+    /// Also stops recording, waiting for buffered records to reach the file.
     Result<void> close() override;
 
+    /// Records dropped because the buffer was full.
+    std::uint64_t dropped_records() const noexcept;
+
 private:
+    struct Writer;
+
     void write_record(std::string_view payload);
 
     std::unique_ptr<Transport> inner;
-    std::FILE* file = nullptr;
+    std::unique_ptr<Writer> writer;
     std::chrono::steady_clock::time_point start;
 };
 
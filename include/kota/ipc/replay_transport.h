@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "kota/ipc/metrics.h"
+#include "kota/ipc/transport.h"
+
+namespace kota::ipc {
+
+struct replay_options {
+    /// Pacing relative to the recording: 2.0 replays twice as fast, 0 sends every message as
+    /// soon as the previous one has been handed over.
+    double speed = 1.0;
+
+    /// Once the trace is exhausted, how long to keep waiting for outstanding responses before
+    /// reporting end of input.
+    std::chrono::milliseconds drain_timeout{5000};
+};
+
+/// What a replay measured, as returned by ReplayTransport::stats().
+struct replay_stats {
+    std::uint64_t requests = 0;
+    std::uint64_t notifications = 0;
+
+    /// Responses matched to a replayed request, and requests still waiting for one.
+    std::uint64_t responses = 0;
+    std::uint64_t unanswered = 0;
+
+    /// Bytes handed to the server and bytes written back by it.
+    std::uint64_t bytes_in = 0;
+    std::uint64_t bytes_out = 0;
+
+    /// Time from handing a request over until its response was written.
+    latency_histogram latency;
+
+    /// From the first message handed over to the last response (or the end of the trace).
+    std::chrono::nanoseconds elapsed{0};
+
+    /// Replayed messages (requests and notifications) per second of `elapsed`.
+    double messages_per_second() const noexcept {
+        const auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0 ? static_cast<double>(requests + notifications) / seconds : 0.0;
+    }
+};
+
+/// Transport that plays the client side of a trace written by RecordingTransport. Hand it to a
+/// server Peer (or relay it to a server process): read_message() yields the recorded messages
+/// at the recorded pacing scaled by `replay_options::speed`, and write_message() matches the
+/// server's responses to the replayed requests by JSON-RPC id to measure their latency.
+class ReplayTransport : public Transport {
+public:
+    /// Load a .jsonl trace. Fails if the file cannot be read or a line is malformed.
+    static Result<std::unique_ptr<ReplayTransport>> open(const std::string& path,
+                                                         replay_options options = {},
+                                                         event_loop& loop = event_loop::current());
+
+    /// Replay records that are already in memory; `lines` are trace lines as written by
+    /// RecordingTransport.
+    static Result<std::unique_ptr<ReplayTransport>>
+        from_lines(std::span<const std::string_view> lines,
+                   replay_options options = {},
+                   event_loop& loop = event_loop::current());
+
+    task<std::optional<MessageBuffer>> read_message() override;
+
+    task<void, Error> write_message(std::string_view payload) override;
+
+    Result<void> close_output() override;
+
+    Result<void> close() override;
+
+    /// Number of messages in the trace.
+    std::size_t size() const noexcept {
+        return records.size();
+    }
+
+    /// Measurements so far; `unanswered` and `elapsed` are filled in once read_message() has
+    /// reported end of input, or on close().
+    const replay_stats& stats() const noexcept {
+        return totals;
+    }
+
+private:
+    struct record {
+        std::chrono::milliseconds at;
+        std::string payload;
+    };
+
+    ReplayTransport(std::vector<record> records, replay_options options, event_loop& loop);
+
+    void finish();
+
+    std::vector<record> records;
+    std::size_t next = 0;
+    replay_options options;
+    event_loop& loop;
+    bool closed = false;
+
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point last_activity;
+
+    /// Replayed requests waiting for a response, keyed by the id's JSON text.
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> outstanding;
+
+    replay_stats totals;
+};
+
+}  // namespace kota::ipc
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kota::ipc::detail {
+
+/// Outgoing requests awaiting a response, keyed by the integer ids the table hands out.
+///
+/// Ids increase monotonically, so a power-of-two slot array indexed by `id & mask` gives every
+/// outstanding id its own slot as long as the oldest and newest are less than the array size
+/// apart. Each slot remembers the id it holds, which doubles as a generation check: a response
+/// for a request that already finished finds another id (or none) in the slot and misses. A
+/// lookup is one index and one compare, with no hashing.
+///
+/// Values live in heap nodes owned by the table and are recycled, not destroyed, when their id
+/// is erased: insert() hands back a previously used Value for the caller to reset. Once the
+/// array has grown to the working set, requests cost no allocation. A Value also outlives its
+/// entry, so an `event` inside it can be set even if the waiter erases the entry while it is
+/// being resumed.
+///
+/// When a new id lands on an occupied slot the array doubles, unless it is already much larger
+/// than the number of live entries. In that case the occupant is a straggler, so it moves to a
+/// small overflow map instead. One request that never gets an answer then cannot make the
+/// array track every id issued after it.
+template <typename Value>
+class request_table {
+public:
+    /// Assign the next id (starting at 1) and claim a Value for it. The Value may hold state
+    /// from an earlier request.
+    std::pair<std::int64_t, Value&> insert() {
+        const auto id = next_id++;
+        if(slots.empty()) {
+            slots.resize(initial_slots);
+            fill_empty_slots({});
+        }
+
+        while(slots[index_of(id)]->id != 0) {
+            if(slots.size() >= sparse_factor * (live + 1)) {
+                auto& straggler = slots[index_of(id)];
+                const auto straggler_id = straggler->id;
+                overflow.emplace(straggler_id, std::exchange(straggler, take_spare()));
+                break;
+            }
+            grow();
+        }
+
+        auto& entry = *slots[index_of(id)];
+        entry.id = id;
+        ++live;
+        return {id, entry.value};
+    }
+
+    /// Value stored under `id`, or nullptr.
+    Value* find(std::int64_t id) noexcept {
+        if(id <= 0 || slots.empty()) {
+            return nullptr;
+        }
+        if(auto& entry = *slots[index_of(id)]; entry.id == id) {
+            return &entry.value;
+        }
+        if(overflow.empty()) {
+            return nullptr;
+        }
+        auto it = overflow.find(id);
+        return it == overflow.end() ? nullptr : &it->second->value;
+    }
+
+    /// Release `id` if it is stored. Its Value stays alive for reuse.
+    void erase(std::int64_t id) {
+        if(id <= 0 || slots.empty()) {
+            return;
+        }
+        if(auto& entry = *slots[index_of(id)]; entry.id == id) {
+            entry.id = 0;
+            --live;
+            return;
+        }
+        if(overflow.empty()) {
+            return;
+        }
+        auto it = overflow.find(id);
+        if(it != overflow.end()) {
+            it->second->id = 0;
+            spare.push_back(std::move(it->second));
+            overflow.erase(it);
+            --live;
+        }
+    }
+
+    /// Ids currently stored, in no particular order.
+    std::vector<std::int64_t> ids() const {
+        std::vector<std::int64_t> out;
+        out.reserve(live);
+        for(const auto& entry: slots) {
+            if(entry->id != 0) {
+                out.push_back(entry->id);
+            }
+        }
+        for(const auto& [id, entry]: overflow) {
+            out.push_back(id);
+        }
+        return out;
+    }
+
+    /// Call `fn(value)` for every stored entry.
+    template <typename Fn>
+    void for_each(Fn&& fn) {
+        for(auto& entry: slots) {
+            if(entry->id != 0) {
+                fn(entry->value);
+            }
+        }
+        for(auto& [id, entry]: overflow) {
+            fn(entry->value);
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return live;
+    }
+
+    bool empty() const noexcept {
+        return live == 0;
+    }
+
+    /// Slots in the array; exposed for tests.
+    std::size_t capacity() const noexcept {
+        return slots.size();
+    }
+
+private:
+    constexpr static std::size_t initial_slots = 16;
+
+    // The array may stay this many times larger than the live entries before colliding
+    // entries are moved to `overflow` rather than doubling it.
+    constexpr static std::size_t sparse_factor = 8;
+
+    struct node {
+        std::int64_t id = 0;
+        Value value{};
+    };
+
+    std::size_t index_of(std::int64_t id) const noexcept {
+        return static_cast<std::size_t>(id) & (slots.size() - 1);
+    }
+
+    std::unique_ptr<node> take_spare() {
+        if(spare.empty()) {
+            return std::make_unique<node>();
+        }
+        auto recycled = std::move(spare.back());
+        spare.pop_back();
+        return recycled;
+    }
+
+    void fill_empty_slots(std::vector<std::unique_ptr<node>> free_nodes) {
+        for(auto& slot: slots) {
+            if(slot) {
+                continue;
+            }
+            if(free_nodes.empty()) {
+                slot = take_spare();
+            } else {
+                slot = std::move(free_nodes.back());
+                free_nodes.pop_back();
+            }
+        }
+    }
+
+    void grow() {
+        std::vector<std::unique_ptr<node>> old(slots.size() * 2);
+        old.swap(slots);
+
+        // Distinct ids in distinct slots modulo n stay distinct modulo 2n.
+        std::vector<std::unique_ptr<node>> free_nodes;
+        for(auto& entry: old) {
+            if(entry->id != 0) {
+                const auto index = index_of(entry->id);
+                slots[index] = std::move(entry);
+            } else {
+                free_nodes.push_back(std::move(entry));
+            }
+        }
+        fill_empty_slots(std::move(free_nodes));
+    }
+
+    std::vector<std::unique_ptr<node>> slots;
+    std::unordered_map<std::int64_t, std::unique_ptr<node>> overflow;
+    std::vector<std::unique_ptr<node>> spare;
+    std::size_t live = 0;
+    std::int64_t next_id = 1;
+};
+
+}  // namespace kota::ipc::detail
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "kota/ipc/transport.h"
+#include "kota/async/async.h"
+
+namespace kota::ipc {
+
+/// Descriptors for one end of a shared-memory link, as handed to another process. Whoever
+/// holds an endpoint owns both descriptors until SharedMemoryTransport::open() adopts them.
+struct shared_memory_endpoint {
+    /// memfd (or unlinked POSIX shm object) holding both rings.
+    int memory_fd = -1;
+
+    /// This end of the socket pair used to wake the other side.
+    int doorbell_fd = -1;
+};
+
+/// Transport for same-host peers. Messages travel through two single-producer,
+/// single-consumer byte rings in a shared memory mapping, one per direction, so each message
+/// is copied once into the ring and once out of it with no kernel copy of the payload. A
+/// one-byte doorbell over a Unix socket pair wakes a side that is sleeping on an empty (or
+/// full) ring; while both sides keep up no syscall is made at all. The socket pair also
+/// reports a crashed peer as end of input.
+///
+/// Messages larger than the ring are streamed through it, so ring size only bounds how far the
+/// writer can run ahead of the reader. Available on Unix-like systems only.
+class SharedMemoryTransport : public Transport {
+public:
+    constexpr static std::size_t default_ring_bytes = 1024 * 1024;
+
+    /// Descriptor numbers spawn() hands the child; open_inherited() expects them there.
+    constexpr static int inherited_memory_fd = 3;
+    constexpr static int inherited_doorbell_fd = 4;
+
+    ~SharedMemoryTransport() override;
+
+    /// Create a link with rings of at least `ring_bytes` (rounded up to a power of two).
+    /// Returns this side's transport and the endpoint for the other side.
+    static Result<std::pair<std::unique_ptr<SharedMemoryTransport>, shared_memory_endpoint>>
+        create(event_loop& loop, std::size_t ring_bytes = default_ring_bytes);
+
+    /// Adopt an endpoint produced by create(), in this process or another one.
+    static Result<std::unique_ptr<SharedMemoryTransport>> open(shared_memory_endpoint endpoint,
+                                                               event_loop& loop);
+
+    /// In a child started by spawn(), open the endpoint it inherited.
+    static Result<std::unique_ptr<SharedMemoryTransport>> open_inherited(event_loop& loop);
+
+    /// Spawn a worker linked to this process by a shared-memory transport. The child's endpoint
+    /// is passed as fds 3 and 4, ahead of any `opts.extra_fds`.
+    static Result<std::pair<process::spawn_result, std::unique_ptr<SharedMemoryTransport>>>
+        spawn(process::options opts,
+              event_loop& loop,
+              std::size_t ring_bytes = default_ring_bytes);
+
+    task<std::optional<MessageBuffer>> read_message() override;
+
+    task<void, Error> write_message(std::string_view payload) override;
+
+    Result<void> close_output() override;
+
+    Result<void> close() override;
+
+private:
+    struct Self;
+
+    explicit SharedMemoryTransport(std::unique_ptr<Self> self);
+
+    std::unique_ptr<Self> self;
+};
+
+}  // namespace kota::ipc
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -14,10 +17,16 @@ class Transport {
 public:
     virtual ~Transport() = default;
 
-    virtual task<std::optional<std::string>> read_message() = 0;
+    /// Read the next message into an owned, padded buffer (see MessageBuffer), or nullopt at end
+    /// of input. Transports should fill the buffer directly so consumers never re-copy it.
+    virtual task<std::optional<MessageBuffer>> read_message() = 0;
 
     virtual task<void, Error> write_message(std::string_view payload) = 0;
 
+    /// Write several messages as one batch. The default writes them one by one; transports
+    /// that can frame a batch into a single I/O operation should override this.
+    virtual task<void, Error> write_messages(std::span<const std::string> payloads);
+
     virtual Result<void> close_output();
 
     /// Close both input and output, aborting any pending read.
@@ -37,18 +46,101 @@ public:
 
     static Result<std::unique_ptr<StreamTransport>> open_tcp(int fd, event_loop& loop);
 
-    task<std::optional<std::string>> read_message() override;
+    task<std::optional<MessageBuffer>> read_message() override;
 
     task<void, Error> write_message(std::string_view payload) override;
 
+    /// Frame every payload and hand all headers and bodies to a single gather write.
+    task<void, Error> write_messages(std::span<const std::string> payloads) override;
+
+    /// Send payloads of at least `threshold` bytes out of band: the payload is copied into a
+    /// sealed memfd whose descriptor rides on a short reference frame, and the receiver maps
+    /// it read-only instead of pulling it through the stream. 0 (the default) turns this off.
+    /// Only an IPC pipe (pipe::options::ipc) read by a StreamTransport can carry attachments;
+    /// on any other output, and on platforms without sealed memfds, payloads are still sent
+    /// inline.
+    void set_attachment_threshold(std::size_t threshold) noexcept {
+        attachment_threshold = threshold;
+    }
+
     Result<void> close_output() override;
 
     Result<void> close() override;
 
 private:
+    /// Consume the next frame header and return its Content-Length, or nullopt if the input
+    /// ended or the header is malformed.
+    task<std::optional<std::size_t>> read_frame_header();
+
+    /// Map the out-of-band payload announced by the current frame header.
+    std::optional<MessageBuffer> take_attachment(std::size_t content_length);
+
+    stream read_stream;
+    stream write_stream;
+    bool shared_stream = false;
+
+    /// Attachment-Length of the frame header just read, if it announced one.
+    std::optional<std::size_t> frame_attachment;
+
+    std::size_t attachment_threshold = 0;
+
+    /// Reused storage for a header that does not fit in one contiguous chunk.
+    std::string header_spill;
+};
+
+/// Frame layout for BinaryTransport.
+struct binary_framing {
+    enum class length_prefix : std::uint8_t {
+        /// Four-byte little-endian payload length.
+        fixed32,
+        /// LEB128 payload length: one byte for payloads under 128 bytes.
+        varint,
+    };
+
+    length_prefix prefix = length_prefix::varint;
+
+    /// Carry one application-defined type byte between the length prefix and the payload.
+    bool type_byte = false;
+};
+
+/// Length-prefixed binary framing for links where both ends are kotatsu peers, typically
+/// carrying BincodeCodec payloads. A frame is the payload length, an optional type byte, then
+/// the payload; there is no text header to scan. Both ends must use the same binary_framing.
+class BinaryTransport : public Transport {
+public:
+    BinaryTransport(stream input, stream output, binary_framing framing = {});
+    explicit BinaryTransport(stream stream, binary_framing framing = {});
+
+    task<std::optional<MessageBuffer>> read_message() override;
+
+    /// Type byte of the last message read; 0 when type bytes are disabled.
+    std::uint8_t last_message_type() const noexcept {
+        return last_type;
+    }
+
+    /// Write one message. With type bytes enabled, it is tagged with `type`; otherwise the tag
+    /// is ignored.
+    task<void, Error> write_message(std::string_view payload, std::uint8_t type);
+
+    task<void, Error> write_message(std::string_view payload) override;
+
+    /// Frame every payload (type 0) and hand them to a single gather write.
+    task<void, Error> write_messages(std::span<const std::string> payloads) override;
+
+    Result<void> close_output() override;
+
+    Result<void> close() override;
+
+private:
+    /// Consume the next frame header and return the payload length, or nullopt if the input
+    /// ended or the prefix is malformed.
+    task<std::optional<std::size_t>> read_frame_header();
+
     stream read_stream;
     stream write_stream;
     bool shared_stream = false;
+    binary_framing framing;
+    std::uint8_t last_type = 0;
 };
 
 }  // namespace kota::ipc
@@ -5,6 +5,7 @@
 #include <deque>
 #include <vector>
 
+#include "timer_wheel.h"
 #include "../libuv.h"
 #include "kota/support/functional.h"
 #include "kota/async/runtime/frame.h"
@@ -28,6 +29,9 @@ struct event_loop::self {
     std::deque<async_node*> tasks;
     std::vector<function<void()>> destroy_callbacks;
 
+    /// Shared by every `deadline` on this loop; see timer_wheel.h.
+    timer_wheel timers;
+
     /// Lock-free MPSC stack head. Writers (any thread) push via CAS in
     /// post(); the single consumer (event loop thread) drains via exchange
     /// in the uv_async_t callback. No mutex required.
@@ -202,6 +206,8 @@ event_loop::event_loop() : self(new struct self()) {
     async.data = self.get();
     // Unref so the async handle alone does not keep the loop alive.
     uv::unref(async);
+
+    self->timers.init(loop);
 }
 
 event_loop::~event_loop() {
@@ -210,7 +216,8 @@ event_loop::~event_loop() {
         if(!uv::is_closing(*h)) {
             auto* idle = uv::as_handle(self->idle);
             auto* async = uv::as_handle(self->async);
-            if(h == idle || h == async) {
+            auto* timers = uv::as_handle(self->timers.handle);
+            if(h == idle || h == async || h == timers) {
                 uv::close(*h, nullptr);
                 return;
             }
@@ -245,6 +252,10 @@ event_loop::~event_loop() {
     }
 }
 
+timer_wheel& timer_wheel::for_loop(event_loop& loop) {
+    return loop->timers;
+}
+
 event_loop::operator uv_loop_t&() noexcept {
     return self->loop;
 }
@@ -153,7 +153,7 @@ result<process::spawn_result> process::spawn(const options& opts, event_loop& lo
     }
 
     std::array<pipe, 3> created_pipes{};
-    std::array<uv_stdio_container_t, 3> stdio{};
+    std::vector<uv_stdio_container_t> stdio(opts.streams.size() + opts.extra_fds.size());
 
     for(std::size_t i = 0; i < opts.streams.size(); ++i) {
         auto& cfg = opts.streams[i];
@@ -193,6 +193,12 @@ result<process::spawn_result> process::spawn(const options& opts, event_loop& lo
         }
     }
 
+    for(std::size_t i = 0; i < opts.extra_fds.size(); ++i) {
+        auto& dst = stdio[opts.streams.size() + i];
+        dst.flags = UV_INHERIT_FD;
+        dst.data.fd = opts.extra_fds[i];
+    }
+
     uv_process_options_t uv_opts{};
     uv_opts.exit_cb = +[](uv_process_t* handle, int64_t exit_status, int term_signal) {
         auto* self = static_cast<process::Self*>(handle->data);
@@ -1,10 +1,17 @@
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <limits>
 #include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "awaiter.h"
+#include "kota/support/small_vector.h"
 
 namespace kota {
 
@@ -234,15 +241,39 @@ struct stream_write_await : uv::await_op<stream_write_await> {
 
     // Stream self that owns the active write waiter.
     stream::Self* self;
-    // Owns outbound bytes until libuv invokes on_write().
+    // Owns outbound bytes until libuv invokes on_write(); empty for gather writes.
     std::vector<char> storage;
+    // Buffers handed to uv_write(); point into storage or at caller-owned memory.
+    small_vector<uv_buf_t, 4> bufs;
+    // Handle whose descriptor rides along with the data (uv_write2), or nullptr.
+    uv_stream_t* send_handle = nullptr;
     // libuv write request; req.data points back to this awaiter.
     uv_write_t req{};
     // Completion status returned from await_resume().
     error error_code;
 
     stream_write_await(stream::Self* self, std::span<const char> data) :
-        self(self), storage(data.begin(), data.end()) {}
+        self(self), storage(data.begin(), data.end()) {
+        bufs.push_back(uv::buf_init(storage.empty() ? nullptr : storage.data(),
+                                    static_cast<unsigned>(storage.size())));
+    }
+
+    stream_write_await(stream::Self* self, std::span<const char> data, uv_stream_t* send_handle) :
+        stream_write_await(self, data) {
+        this->send_handle = send_handle;
+    }
+
+    stream_write_await(stream::Self* self, std::span<const std::span<const char>> buffers) :
+        self(self) {
+        bufs.reserve(buffers.size());
+        for(auto buffer: buffers) {
+            if(buffer.empty()) {
+                continue;
+            }
+            bufs.push_back(uv::buf_init(const_cast<char*>(buffer.data()),
+                                        static_cast<unsigned>(buffer.size())));
+        }
+    }
 
     static void on_cancel(system_op* op) {
         auto* aw = static_cast<stream_write_await*>(op);
@@ -285,9 +316,10 @@ struct stream_write_await : uv::await_op<stream_write_await> {
         self->writer.arm(*this);
         req.data = this;
 
-        uv_buf_t buf = uv::buf_init(storage.empty() ? nullptr : storage.data(),
-                                    static_cast<unsigned>(storage.size()));
-        if(auto err = uv::write(req, self->stream, std::span<const uv_buf_t>{&buf, 1}, on_write)) {
+        auto span = std::span<const uv_buf_t>(bufs.data(), bufs.size());
+        auto err = send_handle ? uv::write2(req, self->stream, span, *send_handle, on_write)
+                               : uv::write(req, self->stream, span, on_write);
+        if(err) {
             error_code = err;
             self->writer.disarm();
             return waiting;
@@ -304,6 +336,43 @@ struct stream_write_await : uv::await_op<stream_write_await> {
     }
 };
 
+#ifndef _WIN32
+
+// libuv only moves descriptors wrapped in stream handles, so a plain descriptor travels in a
+// throwaway pipe handle that is closed (and freed) once it has done its job.
+struct fd_carrier {
+    uv_pipe_t pipe{};
+
+    static result<fd_carrier*> create(uv_loop_t& loop) {
+        auto* carrier = new fd_carrier;
+        if(auto err = uv::pipe_init(loop, carrier->pipe, 0)) {
+            delete carrier;
+            return outcome_error(err);
+        }
+        carrier->pipe.data = carrier;
+        return carrier;
+    }
+
+    static void close(fd_carrier* carrier) {
+        uv::close(carrier->pipe,
+                  [](uv_handle_t* handle) { delete static_cast<fd_carrier*>(handle->data); });
+    }
+};
+
+struct fd_carrier_guard {
+    fd_carrier* carrier;
+
+    ~fd_carrier_guard() {
+        fd_carrier::close(carrier);
+    }
+};
+
+bool is_ipc_pipe(const stream::Self& self) noexcept {
+    return self.handle.type == UV_NAMED_PIPE && self.pipe.ipc != 0;
+}
+
+#endif
+
 }  // namespace
 
 stream::stream() noexcept = default;
@@ -449,6 +518,33 @@ task<void, error> stream::write(std::span<const char> data) {
     }
 }
 
+task<void, error> stream::write(std::span<const std::span<const char>> buffers) {
+    if(!self || !self->initialized()) {
+        co_await fail(error::invalid_argument);
+    }
+
+    std::size_t total = 0;
+    for(auto buffer: buffers) {
+        if(buffer.size() > static_cast<std::size_t>(std::numeric_limits<unsigned>::max())) {
+            co_await fail(error::value_too_large_for_defined_data_type);
+        }
+        total += buffer.size();
+    }
+
+    if(total == 0) {
+        co_await fail(error::invalid_argument);
+    }
+
+    if(self->writer.has_waiter()) {
+        assert(false && "stream::write supports a single writer at a time");
+        co_await fail(error::invalid_argument);
+    }
+
+    if(auto err = co_await stream_write_await{self.get(), buffers}) {
+        co_await fail(std::move(err));
+    }
+}
+
 result<std::size_t> stream::try_write(std::span<const char> data) {
     if(!self || !self->initialized()) {
         return outcome_error(error::invalid_argument);
@@ -499,6 +595,92 @@ error stream::set_blocking(bool enabled) {
     return {};
 }
 
+task<void, error> stream::write_with_fd(std::span<const char> data, int fd) {
+#ifdef _WIN32
+    co_await fail(error::function_not_implemented);
+#else
+    if(!self || !self->initialized() || data.empty() || fd < 0 || !is_ipc_pipe(*self)) {
+        co_await fail(error::invalid_argument);
+    }
+
+    if(self->writer.has_waiter()) {
+        assert(false && "stream::write supports a single writer at a time");
+        co_await fail(error::invalid_argument);
+    }
+
+    auto carrier = fd_carrier::create(*self->handle.loop);
+    if(!carrier) {
+        co_await fail(carrier.error());
+    }
+    fd_carrier_guard guard{*carrier};
+
+    const int copy = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if(copy < 0) {
+        co_await fail(error(uv_translate_sys_error(errno)));
+    }
+    if(auto err = uv::pipe_open((*carrier)->pipe, copy)) {
+        ::close(copy);
+        co_await fail(err);
+    }
+
+    auto* send_handle = reinterpret_cast<uv_stream_t*>(&(*carrier)->pipe);
+    if(auto err = co_await stream_write_await{self.get(), data, send_handle}) {
+        co_await fail(std::move(err));
+    }
+#endif
+}
+
+bool stream::can_send_fds() const noexcept {
+#ifdef _WIN32
+    return false;
+#else
+    return self && self->initialized() && is_ipc_pipe(*self);
+#endif
+}
+
+std::size_t stream::pending_fds() const noexcept {
+#ifdef _WIN32
+    return 0;
+#else
+    if(!self || !self->initialized() || !is_ipc_pipe(*self)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(uv::pipe_pending_count(self->pipe));
+#endif
+}
+
+result<int> stream::take_pending_fd() {
+#ifdef _WIN32
+    return outcome_error(error::function_not_implemented);
+#else
+    if(pending_fds() == 0) {
+        return outcome_error(error::invalid_argument);
+    }
+
+    auto carrier = fd_carrier::create(*self->handle.loop);
+    if(!carrier) {
+        return outcome_error(carrier.error());
+    }
+    fd_carrier_guard guard{*carrier};
+
+    // Accepting moves the descriptor into the carrier, which closes it again; hand out a
+    // duplicate instead.
+    if(auto err = uv::accept(self->pipe, (*carrier)->pipe)) {
+        return outcome_error(err);
+    }
+    auto fd = uv::fileno((*carrier)->pipe);
+    if(!fd) {
+        return outcome_error(fd.error());
+    }
+
+    const int owned = ::fcntl(*fd, F_DUPFD_CLOEXEC, 0);
+    if(owned < 0) {
+        return outcome_error(error(uv_translate_sys_error(errno)));
+    }
+    return owned;
+#endif
+}
+
 stream::stream(unique_handle<Self> self) noexcept : self(std::move(self)) {}
 
 }  // namespace kota
@@ -0,0 +1,138 @@
+#include "kota/async/io/thread_pool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "awaiter.h"
+
+namespace kota {
+
+namespace {
+
+struct pool_op;
+
+}  // namespace
+
+struct thread_pool::self {
+    std::mutex lock;
+    std::condition_variable ready;
+    // Work no thread has picked up yet, oldest first.
+    std::deque<pool_op*> pending;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+
+    // Remove `op` if no thread has started it. Called on the loop thread.
+    bool withdraw(pool_op* op) {
+        std::lock_guard guard(lock);
+        auto it = std::ranges::find(pending, op);
+        if(it == pending.end()) {
+            return false;
+        }
+        pending.erase(it);
+        return true;
+    }
+
+    void work();
+};
+
+namespace {
+
+struct pool_op : uv::await_op<pool_op> {
+    using promise_t = task<>::promise_type;
+
+    struct thread_pool::self* pool;
+    // User-supplied function executed on a pool thread.
+    function<void()> fn;
+    // Keeps the loop alive until the work is done and carries the completion back to it.
+    std::optional<relay> done;
+
+    pool_op(struct thread_pool::self* pool, function<void()> fn) :
+        pool(pool), fn(std::move(fn)) {}
+
+    static void on_cancel(system_op* op) {
+        auto* self = static_cast<pool_op*>(op);
+        // Work that is already running completes through `done` as usual.
+        if(self->pool->withdraw(self)) {
+            self->state = async_node::Cancelled;
+            self->done.reset();
+            self->complete();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_t> waiting,
+                      std::source_location loc = std::source_location::current()) noexcept {
+        return this->link_continuation(&waiting.promise(), loc);
+    }
+
+    void await_resume() noexcept {}
+};
+
+}  // namespace
+
+void thread_pool::self::work() {
+    while(true) {
+        pool_op* op = nullptr;
+        {
+            std::unique_lock guard(lock);
+            ready.wait(guard, [&] { return stopping || !pending.empty(); });
+            if(stopping) {
+                return;
+            }
+            op = pending.front();
+            pending.pop_front();
+        }
+
+        op->fn();
+        // The loop may resume the awaiting coroutine, and so free `op`, as soon as the relay
+        // is sent; take it out first.
+        auto done = std::move(*op->done);
+        done.send([op] { op->complete(); });
+    }
+}
+
+thread_pool::thread_pool(std::size_t threads) : self(std::make_unique<struct self>()) {
+    threads = std::max<std::size_t>(threads, 1);
+    self->threads.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i) {
+        self->threads.emplace_back([state = self.get()] { state->work(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard guard(self->lock);
+        self->stopping = true;
+    }
+    self->ready.notify_all();
+    for(auto& thread: self->threads) {
+        thread.join();
+    }
+}
+
+std::size_t thread_pool::size() const noexcept {
+    return self->threads.size();
+}
+
+task<> thread_pool::run(function<void()> fn, event_loop& loop) {
+    pool_op op(self.get(), std::move(fn));
+    op.done.emplace(loop.create_relay());
+    {
+        std::lock_guard guard(self->lock);
+        self->pending.push_back(&op);
+    }
+    self->ready.notify_one();
+
+    co_await op;
+}
+
+}  // namespace kota
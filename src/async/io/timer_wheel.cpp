@@ -0,0 +1,265 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+namespace kota {
+
+namespace {
+
+constexpr std::uint64_t no_deadline = UINT64_MAX;
+
+constexpr std::uint64_t bit(std::uint64_t slot) noexcept {
+    return std::uint64_t(1) << slot;
+}
+
+}  // namespace
+
+timer_wheel::~timer_wheel() {
+    for(auto& level: slots) {
+        for(auto& head: level) {
+            while(head.next != nullptr && head.next != &head) {
+                auto& entry = static_cast<deadline&>(*head.next);
+                unlink(entry);
+                entry.wheel = nullptr;
+            }
+        }
+    }
+}
+
+void timer_wheel::init(uv_loop_t& uv_loop) {
+    loop = &uv_loop;
+    uv::timer_init(uv_loop, handle);
+    handle.data = this;
+    current = uv::now(uv_loop);
+    for(auto& level: slots) {
+        for(auto& head: level) {
+            head.prev = &head;
+            head.next = &head;
+        }
+    }
+}
+
+void timer_wheel::arm(deadline& entry, std::chrono::milliseconds timeout) {
+    assert(loop != nullptr && "timer_wheel::arm before init");
+    assert(entry.wheel == nullptr && "timer_wheel::arm on an armed deadline");
+
+    const auto now = uv::now(*loop);
+    if(count == 0) {
+        // Nothing is filed relative to the old tick, so skip the idle stretch outright.
+        current = std::max(current, now);
+    }
+
+    const auto delay = static_cast<std::uint64_t>(std::max<std::int64_t>(timeout.count(), 0));
+    auto expires = std::max(now + std::min(delay, max_timeout), current);
+    entry.expires = std::min(expires, current + max_timeout);
+    entry.wheel = this;
+    place(entry);
+    count += 1;
+
+    // Inside advance() the timer is re-armed once everything due has fired.
+    if(!firing) {
+        rearm();
+    }
+}
+
+void timer_wheel::cancel(deadline& entry) noexcept {
+    unlink(entry);
+    auto& head = slots[entry.level][entry.slot];
+    if(head.next == &head) {
+        occupied[entry.level] &= ~bit(entry.slot);
+    }
+    entry.wheel = nullptr;
+    count -= 1;
+
+    // A timer left armed only costs one spurious wakeup, but an empty wheel must not keep the
+    // loop alive.
+    if(count == 0 && !firing && armed_due != no_deadline) {
+        uv::timer_stop(handle);
+        armed_due = no_deadline;
+    }
+}
+
+void timer_wheel::on_timer(uv_timer_t* handle) {
+    auto* wheel = static_cast<timer_wheel*>(handle->data);
+    assert(wheel != nullptr && "on_timer requires the wheel in handle->data");
+
+    wheel->armed_due = no_deadline;
+    wheel->advance(uv::now(*wheel->loop));
+    wheel->rearm();
+}
+
+void timer_wheel::unlink(detail::timer_link& link) noexcept {
+    link.prev->next = link.next;
+    link.next->prev = link.prev;
+    link.prev = nullptr;
+    link.next = nullptr;
+}
+
+void timer_wheel::splice(detail::timer_link& from, detail::timer_link& to) noexcept {
+    if(from.next == &from) {
+        to.prev = &to;
+        to.next = &to;
+        return;
+    }
+    to.next = from.next;
+    to.prev = from.prev;
+    to.next->prev = &to;
+    to.prev->next = &to;
+    from.prev = &from;
+    from.next = &from;
+}
+
+void timer_wheel::place(deadline& entry) noexcept {
+    // The highest digit where expiry and current tick differ picks the level. The expiry's
+    // digit there is then always ahead of the current one, so the slot is still to come.
+    const auto diff = entry.expires ^ current;
+    unsigned level = 0;
+    while(level + 1 < levels && (diff >> (slot_bits * (level + 1))) != 0) {
+        level += 1;
+    }
+    const auto slot = (entry.expires >> (slot_bits * level)) & slot_mask;
+
+    entry.level = static_cast<std::uint8_t>(level);
+    entry.slot = static_cast<std::uint8_t>(slot);
+
+    // Append, so deadlines due on the same tick fire in the order they were armed.
+    auto& head = slots[level][slot];
+    entry.prev = head.prev;
+    entry.next = &head;
+    head.prev->next = &entry;
+    head.prev = &entry;
+    occupied[level] |= bit(slot);
+}
+
+void timer_wheel::cascade(std::uint64_t tick) noexcept {
+    for(unsigned level = 1; level < levels; ++level) {
+        const auto shift = slot_bits * level;
+        if((tick & ((std::uint64_t(1) << shift) - 1)) != 0) {
+            break;
+        }
+
+        const auto slot = (tick >> shift) & slot_mask;
+        if((occupied[level] & bit(slot)) == 0) {
+            continue;
+        }
+        occupied[level] &= ~bit(slot);
+
+        detail::timer_link moving;
+        splice(slots[level][slot], moving);
+        while(moving.next != &moving) {
+            auto& entry = static_cast<deadline&>(*moving.next);
+            unlink(entry);
+            place(entry);
+        }
+    }
+}
+
+void timer_wheel::advance(std::uint64_t now) {
+    firing = true;
+    while(count != 0) {
+        const auto tick = current;
+        if((tick & slot_mask) == 0) {
+            cascade(tick);
+        }
+
+        const auto slot = tick & slot_mask;
+        if((occupied[0] & bit(slot)) != 0) {
+            occupied[0] &= ~bit(slot);
+
+            // Detach the slot first: deadlines armed by the callbacks, even for this very
+            // tick, wait for the next pass instead of being fired in a loop.
+            detail::timer_link due;
+            splice(slots[0][slot], due);
+            while(due.next != &due) {
+                auto& entry = static_cast<deadline&>(*due.next);
+                unlink(entry);
+                entry.wheel = nullptr;
+                count -= 1;
+
+                // The callback may destroy the deadline, so it runs from a local.
+                auto callback = std::move(entry.callback);
+                callback();
+            }
+        }
+
+        if(tick >= now) {
+            break;
+        }
+        // Jump straight to the next tick with work, never past `now`.
+        current = std::clamp(next_due(), tick + 1, now);
+    }
+
+    if(count == 0) {
+        current = std::max(current, now);
+    }
+    firing = false;
+}
+
+std::uint64_t timer_wheel::next_due() const noexcept {
+    auto due = no_deadline;
+    for(unsigned level = 0; level < levels; ++level) {
+        if(occupied[level] == 0) {
+            continue;
+        }
+
+        const auto shift = slot_bits * level;
+        const auto digit = static_cast<int>((current >> shift) & slot_mask);
+
+        // Rotate so bit k stands for the slot k steps ahead of the current digit. Level 0
+        // includes the current tick itself; higher levels never hold the current digit.
+        auto ahead = std::rotr(occupied[level], digit);
+        if(level != 0) {
+            ahead &= ~std::uint64_t(1);
+        }
+        if(ahead == 0) {
+            continue;
+        }
+
+        const auto block = current >> (shift + slot_bits) << (shift + slot_bits);
+        const auto steps = static_cast<std::uint64_t>(digit + std::countr_zero(ahead));
+        due = std::min(due, block + (steps << shift));
+    }
+    return due;
+}
+
+void timer_wheel::rearm() {
+    if(count == 0) {
+        if(armed_due != no_deadline) {
+            uv::timer_stop(handle);
+            armed_due = no_deadline;
+        }
+        return;
+    }
+
+    const auto due = next_due();
+    if(due == armed_due) {
+        return;
+    }
+
+    const auto now = uv::now(*loop);
+    armed_due = due;
+    uv::timer_start(handle, on_timer, due > now ? due - now : 0, 0);
+}
+
+deadline::deadline(event_loop& loop) noexcept : loop(&loop) {}
+
+deadline::~deadline() {
+    cancel();
+}
+
+void deadline::arm(std::chrono::milliseconds timeout, function<void()> callback) {
+    cancel();
+    this->callback = std::move(callback);
+    timer_wheel::for_loop(*loop).arm(*this, timeout);
+}
+
+void deadline::cancel() noexcept {
+    if(wheel != nullptr) {
+        wheel->cancel(*this);
+    }
+}
+
+}  // namespace kota
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "../libuv.h"
+#include "kota/async/io/watcher.h"
+
+namespace kota {
+
+/// Deadlines of one event loop, driven by a single uv_timer_t.
+///
+/// A hierarchical timing wheel: level L has 64 slots of 64^L milliseconds, and six levels span
+/// about 795 days. A deadline is filed at the highest base-64 digit in which its expiry differs
+/// from the current tick, so arming and cancelling are O(1) list operations. When the current
+/// tick reaches a higher-level slot, that slot's deadlines are refiled at lower levels.
+/// Per-level occupancy bitmaps find the next tick with work without scanning slots, and the
+/// libuv timer is only ever armed for that tick.
+struct timer_wheel {
+    constexpr static unsigned slot_bits = 6;
+    constexpr static unsigned slots_per_level = 1U << slot_bits;
+    constexpr static std::uint64_t slot_mask = slots_per_level - 1;
+    constexpr static unsigned levels = 6;
+
+    /// Longest timeout honoured exactly; longer ones fire after this long.
+    constexpr static std::uint64_t max_timeout =
+        (std::uint64_t(1) << (slot_bits * levels)) - 1;
+
+    timer_wheel() = default;
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    /// Detaches any deadline still armed, so destroying it later is harmless.
+    ~timer_wheel();
+
+    /// Set up the libuv timer; called once the loop itself is initialized.
+    void init(uv_loop_t& uv_loop);
+
+    void arm(deadline& entry, std::chrono::milliseconds timeout);
+
+    void cancel(deadline& entry) noexcept;
+
+    /// The wheel owned by `loop`.
+    static timer_wheel& for_loop(event_loop& loop);
+
+    uv_timer_t handle{};
+
+private:
+    static void on_timer(uv_timer_t* handle);
+
+    static void unlink(detail::timer_link& link) noexcept;
+
+    // Move every entry of `from` onto the empty list `to`.
+    static void splice(detail::timer_link& from, detail::timer_link& to) noexcept;
+
+    void place(deadline& entry) noexcept;
+
+    // Refile the higher-level slots that start at tick `tick`.
+    void cascade(std::uint64_t tick) noexcept;
+
+    // Fire everything due up to and including `now`.
+    void advance(std::uint64_t now);
+
+    // Earliest tick at which there is something to fire or refile.
+    std::uint64_t next_due() const noexcept;
+
+    // Point the libuv timer at next_due(), or stop it if the wheel is empty.
+    void rearm();
+
+    uv_loop_t* loop = nullptr;
+    std::array<std::array<detail::timer_link, slots_per_level>, levels> slots{};
+    std::array<std::uint64_t, levels> occupied{};
+    std::uint64_t current = 0;
+    std::uint64_t armed_due = UINT64_MAX;
+    std::size_t count = 0;
+    bool firing = false;
+};
+
+}  // namespace kota
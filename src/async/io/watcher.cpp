@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include "awaiter.h"
+#include "timer_wheel.h"
 #include "kota/async/io/loop.h"
 #include "kota/async/vocab/error.h"
 
@@ -371,10 +372,42 @@ KOTA_DEFINE_TICK_WATCHER_METHODS(check,
 
 #undef KOTA_DEFINE_TICK_WATCHER_METHODS
 
+namespace {
+
+struct sleep_await : uv::await_op<sleep_await> {
+    using await_base = uv::await_op<sleep_await>;
+    using promise_t = task<>::promise_type;
+
+    // Entry on the loop's timer wheel, owned by the sleeping coroutine's frame.
+    deadline* alarm;
+    std::chrono::milliseconds timeout;
+
+    sleep_await(deadline* alarm, std::chrono::milliseconds timeout) :
+        alarm(alarm), timeout(timeout) {}
+
+    static void on_cancel(system_op* op) {
+        await_base::complete_cancel(op, [](auto& aw) { aw.alarm->cancel(); });
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_t> waiting,
+                      std::source_location loc = std::source_location::current()) noexcept {
+        alarm->arm(timeout, [this] { this->complete(); });
+        return this->link_continuation(&waiting.promise(), loc);
+    }
+
+    void await_resume() noexcept {}
+};
+
+}  // namespace
+
 task<> sleep(std::chrono::milliseconds timeout, event_loop& loop) {
-    auto t = timer::create(loop);
-    t.start(timeout, std::chrono::milliseconds{0});
-    co_await t.wait();
+    deadline alarm(loop);
+    co_await sleep_await{&alarm, timeout};
 }
 
 }  // namespace kota
@@ -258,6 +258,10 @@ ALWAYS_INLINE void timer_stop(uv_timer_t& handle) noexcept {
     assert(rc == 0 && "uv::timer_stop failed");
 }
 
+ALWAYS_INLINE std::uint64_t now(const uv_loop_t& loop) noexcept {
+    return ::uv_now(&loop);
+}
+
 ALWAYS_INLINE error poll_init_socket(uv_loop_t& loop,
                                      uv_poll_t& handle,
                                      uv_os_sock_t socket) noexcept {
@@ -320,6 +324,22 @@ ALWAYS_INLINE error
         ::uv_write(&req, as_stream(stream), bufs.data(), static_cast<unsigned>(bufs.size()), cb));
 }
 
+template <stream_like S, stream_like H>
+ALWAYS_INLINE error write2(uv_write_t& req,
+                           S& stream,
+                           std::span<const uv_buf_t> bufs,
+                           H& send_handle,
+                           uv_write_cb cb) noexcept {
+    assert(!bufs.empty() && "uv::write2 requires a non-empty buffer span");
+    // Errors: as uv::write, plus UV_EINVAL when the stream is not an IPC pipe.
+    return status_to_error(::uv_write2(&req,
+                                       as_stream(stream),
+                                       bufs.data(),
+                                       static_cast<unsigned>(bufs.size()),
+                                       as_stream(send_handle),
+                                       cb));
+}
+
 template <stream_like Server, stream_like Client>
 ALWAYS_INLINE error accept(Server& server, Client& client) noexcept {
     return status_to_error(::uv_accept(as_stream(server), as_stream(client)));
@@ -339,6 +359,19 @@ ALWAYS_INLINE error pipe_open(uv_pipe_t& handle, uv_file fd) noexcept {
     return status_to_error(::uv_pipe_open(&handle, fd));
 }
 
+ALWAYS_INLINE int pipe_pending_count(uv_pipe_t& handle) noexcept {
+    return ::uv_pipe_pending_count(&handle);
+}
+
+template <handle_like H>
+ALWAYS_INLINE result<uv_os_fd_t> fileno(H& handle) noexcept {
+    uv_os_fd_t fd{};
+    if(auto err = status_to_error(::uv_fileno(as_handle(handle), &fd))) {
+        return outcome_error(err);
+    }
+    return fd;
+}
+
 ALWAYS_INLINE error pipe_bind2(uv_pipe_t& handle,
                                const char* name,
                                std::size_t namelen,
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -21,6 +22,21 @@ struct bincode_notification {
     codec::RawValue params;
 };
 
+// Decoding counterparts of the request/notification envelopes: params borrow from the
+// message buffer instead of being copied out.
+// Strings and byte blobs share the same length-prefixed encoding, so `method` can be
+// borrowed as raw bytes too.
+struct bincode_incoming_request {
+    protocol::RequestID id;
+    codec::RawValueView method;
+    codec::RawValueView params;
+};
+
+struct bincode_incoming_notification {
+    codec::RawValueView method;
+    codec::RawValueView params;
+};
+
 struct bincode_success {
     protocol::RequestID id;
     codec::RawValue result;
@@ -36,6 +52,13 @@ struct bincode_error {
 using bincode_envelope =
     std::variant<bincode_request, bincode_notification, bincode_success, bincode_error>;
 
+// Must list the alternatives in the same order as bincode_envelope: the variant index is the
+// wire tag.
+using bincode_incoming_envelope = std::variant<bincode_incoming_request,
+                                               bincode_incoming_notification,
+                                               bincode_success,
+                                               bincode_error>;
+
 Result<std::string> encode_envelope(const bincode_envelope& envelope) {
     auto bytes = codec::bincode::to_bytes(envelope);
     if(!bytes) {
@@ -46,11 +69,12 @@ Result<std::string> encode_envelope(const bincode_envelope& envelope) {
 
 }  // namespace
 
-IncomingMessage BincodeCodec::parse_message(std::string_view payload) {
-    auto bytes_span = std::span<const std::byte>(reinterpret_cast<const std::byte*>(payload.data()),
-                                                 payload.size());
+IncomingMessage BincodeCodec::parse_message(std::shared_ptr<const MessageBuffer> payload) {
+    auto text = payload->view();
+    auto bytes_span =
+        std::span<const std::byte>(reinterpret_cast<const std::byte*>(text.data()), text.size());
 
-    bincode_envelope envelope;
+    bincode_incoming_envelope envelope;
     auto status = codec::bincode::from_bytes(bytes_span, envelope);
     if(!status) {
         return IncomingParseError{
@@ -58,12 +82,16 @@ IncomingMessage BincodeCodec::parse_message(std::string_view payload) {
     }
 
     return std::visit(
-        [](auto&& v) -> IncomingMessage {
+        [&payload, size = text.size()](auto&& v) -> IncomingMessage {
             using T = std::remove_cvref_t<decltype(v)>;
-            if constexpr(std::is_same_v<T, bincode_request>) {
-                return IncomingRequest{v.id, std::move(v.method), std::move(v.params.data)};
-            } else if constexpr(std::is_same_v<T, bincode_notification>) {
-                return IncomingNotification{std::move(v.method), std::move(v.params.data)};
+            if constexpr(std::is_same_v<T, bincode_incoming_request>) {
+                return IncomingRequest{v.id,
+                                       v.method.data,
+                                       v.params.data,
+                                       std::move(payload),
+                                       size};
+            } else if constexpr(std::is_same_v<T, bincode_incoming_notification>) {
+                return IncomingNotification{v.method.data, v.params.data, std::move(payload), size};
             } else if constexpr(std::is_same_v<T, bincode_success>) {
                 return IncomingResponse{v.id, std::move(v.result.data)};
             } else if constexpr(std::is_same_v<T, bincode_error>) {
@@ -1,7 +1,10 @@
 #include "kota/codec/json/json.h"
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "kota/ipc/codec/json.h"
 
@@ -47,8 +50,10 @@ struct outgoing_error_response_message {
 
 struct json_rpc_incoming {
     std::optional<protocol::RequestID> id;
-    std::optional<std::string> method;
-    std::optional<codec::RawValue> params;
+    // Raw token so the name can be looked up straight from the payload.
+    std::optional<codec::RawValueView> method;
+    // Borrowed from the message buffer; the typed handler decodes it in place later.
+    std::optional<codec::RawValueView> params;
     // Not optional<RawValue> because "result": null is a valid success
     // response — optional would lose it as nullopt. defaulted<RawValue>
     // keeps absent → empty(), null → "null" text.
@@ -56,26 +61,134 @@ struct json_rpc_incoming {
     std::optional<Error> error;
 };
 
+// Turn the raw `method` token into the name. Plain names are returned as a view into the
+// payload; only names containing escapes are decoded, into `scratch`.
+std::optional<std::string_view> method_name(std::string_view raw,
+                                            codec::json::parse_context& context,
+                                            std::string& scratch) {
+    while(!raw.empty() && (raw.back() == ' ' || raw.back() == '\t' || raw.back() == '\n' ||
+                           raw.back() == '\r')) {
+        raw.remove_suffix(1);
+    }
+    if(raw.size() < 2 || raw.front() != '"' || raw.back() != '"') {
+        return std::nullopt;
+    }
+
+    auto name = raw.substr(1, raw.size() - 2);
+    if(name.find('\\') == std::string_view::npos) {
+        return name;
+    }
+
+    auto decoded = codec::json::from_json<std::string>(context, raw);
+    if(!decoded) {
+        return std::nullopt;
+    }
+    scratch = std::move(*decoded);
+    return std::string_view(scratch);
+}
+
 }  // namespace
 
-IncomingMessage JsonCodec::parse_message(std::string_view payload) {
-    auto envelope = codec::json::parse<json_rpc_incoming>(payload);
+IncomingMessage JsonCodec::parse_message(std::shared_ptr<const MessageBuffer> payload) {
+    auto text = payload->view();
+    return parse_envelope(text, std::move(payload), method_scratch);
+}
+
+bool JsonCodec::is_batch(std::string_view payload) noexcept {
+    auto start = payload.find_first_not_of(" \t\r\n");
+    return start != std::string_view::npos && payload[start] == '[';
+}
+
+bool JsonCodec::parse_batch(std::shared_ptr<const MessageBuffer> payload,
+                            std::vector<IncomingMessage>& out) {
+    out.clear();
+    batch_scratch.clear();
+
+    auto text = payload->view();
+    auto elements = codec::json::from_json<std::vector<codec::RawValueView>>(
+        json_context,
+        simdjson::padded_string_view(text.data(), text.size(), text.size() + MessageBuffer::padding));
+    if(!elements) {
+        out.emplace_back(IncomingParseError{
+            Error(protocol::ErrorCode::ParseError, elements.error().to_string())});
+        return false;
+    }
+    if(elements->empty()) {
+        out.emplace_back(
+            IncomingParseError{Error(protocol::ErrorCode::InvalidRequest, "empty batch")});
+        return false;
+    }
+
+    // Each element is a subrange of the payload. What follows it is the rest of the payload
+    // and then the buffer's padding, which together are at least as long as the padding
+    // simdjson needs, so the element can be parsed in place like a standalone message.
+    out.reserve(elements->size());
+    for(auto& element: *elements) {
+        out.push_back(parse_envelope(element.data, payload, batch_scratch.emplace_back()));
+    }
+    return true;
+}
+
+std::string JsonCodec::encode_batch(std::span<const std::string> messages) {
+    std::size_t bytes = 2 + messages.size();
+    for(const auto& message: messages) {
+        bytes += message.size();
+    }
+
+    std::string batch;
+    batch.reserve(bytes);
+    batch.push_back('[');
+    for(std::string_view message: messages) {
+        // A message that is a batch itself, such as the replies to an incoming batch, is
+        // spliced in so the result stays a flat array.
+        if(is_batch(message)) {
+            message.remove_prefix(message.find('[') + 1);
+            message.remove_suffix(message.size() - message.rfind(']'));
+            if(message.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                continue;
+            }
+        }
+        if(batch.size() != 1) {
+            batch.push_back(',');
+        }
+        batch.append(message);
+    }
+    batch.push_back(']');
+    return batch;
+}
+
+IncomingMessage JsonCodec::parse_envelope(std::string_view text,
+                                          std::shared_ptr<const MessageBuffer> payload,
+                                          std::string& scratch) {
+    static_assert(MessageBuffer::padding >= simdjson::SIMDJSON_PADDING);
+
+    // The buffer's zeroed tail doubles as simdjson padding, so the envelope is parsed without
+    // first being copied into a padded_string.
+    auto envelope = codec::json::from_json<json_rpc_incoming>(
+        json_context,
+        simdjson::padded_string_view(text.data(), text.size(), text.size() + MessageBuffer::padding));
     if(!envelope) {
         return IncomingParseError{
             Error(protocol::ErrorCode::ParseError, envelope.error().to_string())};
     }
 
-    auto raw_params =
-        envelope->params.has_value() ? std::move(envelope->params->data) : std::string{};
+    auto raw_params = envelope->params.has_value() ? envelope->params->data : std::string_view{};
 
     // Has method → request or notification
     if(envelope->method.has_value()) {
+        auto method = method_name(envelope->method->data, json_context, scratch);
+        if(!method) {
+            return IncomingParseError{
+                Error(protocol::ErrorCode::ParseError, "method must be a string")};
+        }
         if(envelope->id.has_value()) {
             return IncomingRequest{*envelope->id,
-                                   std::move(*envelope->method),
-                                   std::move(raw_params)};
+                                   *method,
+                                   raw_params,
+                                   std::move(payload),
+                                   text.size()};
         }
-        return IncomingNotification{std::move(*envelope->method), std::move(raw_params)};
+        return IncomingNotification{*method, raw_params, std::move(payload), text.size()};
     }
 
     // No method + has id → response
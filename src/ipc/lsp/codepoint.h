@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "simd.h"
+#include "kota/ipc/lsp/position.h"
+
+namespace kota::ipc::lsp::detail {
+
+// Decodes one UTF-8 code point starting at `index`.
+// Returns:
+// - first: consumed UTF-8 byte count
+// - second: corresponding UTF-16 code unit count
+// For invalid/truncated sequences it falls back to {1, 1} so callers can
+// keep scanning forward without getting stuck.
+inline std::pair<std::uint32_t, std::uint32_t> next_codepoint_sizes(std::string_view text,
+                                                                    std::size_t index) {
+    assert(index < text.size() && "index out of range");
+
+    // First byte >= ascii_limit starts a multi-byte UTF-8 sequence.
+    constexpr unsigned char ascii_limit = 0x80u;
+
+    // Continuation byte shape is 10xxxxxx.
+    constexpr unsigned char continuation_mask = 0xC0u;
+    constexpr unsigned char continuation_value = 0x80u;
+
+    // Minimum valid 2-byte lead is C2 (C0/C1 are overlong).
+    constexpr unsigned char two_byte_min = 0xC2u;
+
+    // Lead-byte region boundaries.
+    constexpr unsigned char three_byte_min = 0xE0u;
+    constexpr unsigned char four_byte_min = 0xF0u;
+    constexpr unsigned char four_byte_exclusive_max = 0xF5u;
+
+    // E0 xx needs b2 >= A0 to avoid overlong 3-byte encoding.
+    constexpr unsigned char three_byte_overlong_lead = 0xE0u;
+    constexpr unsigned char three_byte_overlong_b2_min = 0xA0u;
+
+    // ED A0..BF would encode UTF-16 surrogate range.
+    constexpr unsigned char surrogate_lead = 0xEDu;
+    constexpr unsigned char surrogate_b2_min = 0xA0u;
+
+    // F0 xx needs b2 >= 90 to avoid overlong 4-byte encoding.
+    constexpr unsigned char four_byte_overlong_lead = 0xF0u;
+    constexpr unsigned char four_byte_overlong_b2_min = 0x90u;
+
+    // F4 b2 must stay below 90 to remain <= U+10FFFF.
+    constexpr unsigned char unicode_max_lead = 0xF4u;
+    constexpr unsigned char unicode_max_b2_exclusive = 0x90u;
+
+    // Inspect the leading byte to determine UTF-8 sequence width.
+    const auto lead = static_cast<unsigned char>(text[index]);
+
+    // 0xxxxxxx: ASCII, one UTF-8 byte and one UTF-16 code unit.
+    if(lead < ascii_limit) [[likely]] {
+        // ASCII is already a complete code point.
+        return {1, 1};
+    }
+
+    // Invalid leading byte:
+    // - 10xxxxxx: continuation byte
+    // - 0xC0/0xC1: overlong 2-byte lead
+    if(lead < two_byte_min) [[unlikely]] {
+        // Invalid lead byte, consume one byte to keep forward progress.
+        return {1, 1};
+    }
+
+    if(lead < three_byte_min) {
+        // 2-byte UTF-8 lead range: C2..DF
+        if(index + 2 > text.size()) [[unlikely]] {
+            // Truncated 2-byte sequence at input end.
+            return {1, 1};
+        }
+
+        // UTF-8 continuation byte must match 10xxxxxx.
+        const auto b2 = static_cast<unsigned char>(text[index + 1]);
+        if((b2 & continuation_mask) != continuation_value) [[unlikely]] {
+            // Second byte is not a valid continuation byte.
+            return {1, 1};
+        }
+
+        return {2, 1};
+    }
+
+    if(lead < four_byte_min) {
+        // 3-byte UTF-8 lead range: E0..EF
+        if(index + 3 > text.size()) [[unlikely]] {
+            // Truncated 3-byte sequence at input end.
+            return {1, 1};
+        }
+
+        const auto b2 = static_cast<unsigned char>(text[index + 1]);
+        const auto b3 = static_cast<unsigned char>(text[index + 2]);
+        if((b2 & continuation_mask) != continuation_value ||
+           (b3 & continuation_mask) != continuation_value) [[unlikely]] {
+            // One of the continuation bytes is malformed.
+            return {1, 1};
+        }
+
+        // E0 A0..BF ...: prevent overlong 3-byte sequences.
+        if(lead == three_byte_overlong_lead && b2 < three_byte_overlong_b2_min) [[unlikely]] {
+            // Overlong encoding for a code point that needs fewer bytes.
+            return {1, 1};
+        }
+
+        // ED 80..9F ...: exclude UTF-16 surrogate code points.
+        if(lead == surrogate_lead && b2 >= surrogate_b2_min) [[unlikely]] {
+            // UTF-16 surrogate range is invalid in UTF-8.
+            return {1, 1};
+        }
+
+        return {3, 1};
+    }
+
+    if(lead < four_byte_exclusive_max) {
+        // 4-byte UTF-8 lead range: F0..F4 (Unicode max U+10FFFF).
+        if(index + 4 > text.size()) [[unlikely]] {
+            // Truncated 4-byte sequence at input end.
+            return {1, 1};
+        }
+
+        const auto b2 = static_cast<unsigned char>(text[index + 1]);
+        const auto b3 = static_cast<unsigned char>(text[index + 2]);
+        const auto b4 = static_cast<unsigned char>(text[index + 3]);
+        if((b2 & continuation_mask) != continuation_value ||
+           (b3 & continuation_mask) != continuation_value ||
+           (b4 & continuation_mask) != continuation_value) [[unlikely]] {
+            // One of the continuation bytes is malformed.
+            return {1, 1};
+        }
+
+        // F0 90..BF ...: prevent overlong 4-byte sequences.
+        if(lead == four_byte_overlong_lead && b2 < four_byte_overlong_b2_min) [[unlikely]] {
+            // Overlong encoding for code points below U+10000.
+            return {1, 1};
+        }
+
+        // F4 80..8F ...: stay within U+10FFFF upper bound.
+        if(lead == unicode_max_lead && b2 >= unicode_max_b2_exclusive) [[unlikely]] {
+            // Would decode beyond maximum Unicode scalar value.
+            return {1, 1};
+        }
+
+        return {4, 2};
+    }
+
+    // F5..FF are invalid in UTF-8.
+    // Invalid lead byte range, consume one byte conservatively.
+    return {1, 1};
+}
+
+
+// Code units in the longest well-formed prefix of one block, with that prefix's byte length.
+struct block_units {
+    std::uint32_t bytes;
+    std::uint32_t utf16;
+    std::uint32_t utf32;
+};
+
+// Counts the block at `data` with bitmask arithmetic instead of decoding. The prefix stops
+// before a sequence that runs past the block end, or before the code point holding the first
+// malformed byte, so it agrees with next_codepoint_sizes(). A zero-byte result means the block
+// starts with something only the scalar decoder can handle.
+inline block_units scan_block(const char* data) noexcept {
+    constexpr auto width = simd::block::width;
+    const simd::block block(data);
+
+    const auto high = block.ge(0x80);
+    if(high == 0) [[likely]] {
+        return {width, width, width};
+    }
+
+    const auto ge_90 = block.ge(0x90);
+    const auto ge_a0 = block.ge(0xA0);
+    const auto ge_c0 = block.ge(0xC0);
+    const auto ge_c2 = block.ge(0xC2);
+    const auto ge_e0 = block.ge(0xE0);
+    const auto ge_f0 = block.ge(0xF0);
+    const auto ge_f5 = block.ge(0xF5);
+
+    const auto continuation = high & ~ge_c0;
+    const auto lead2 = ge_c2 & ~ge_e0;
+    const auto lead3 = ge_e0 & ~ge_f0;
+    const auto lead4 = ge_f0 & ~ge_f5;
+    const auto bad_lead = (ge_c0 & ~ge_c2) | ge_f5;
+
+    // Every lead must be followed by exactly its continuation bytes, and the second byte after
+    // E0, ED, F0 and F4 must stay in the ranges that rule out overlong, surrogate and too-large
+    // code points. Bits shifted past the block belong to a sequence that runs past its end.
+    const auto expected = ((lead2 | lead3 | lead4) << 1) | ((lead3 | lead4) << 2) | (lead4 << 3);
+    const auto second_invalid = ((block.eq(0xE0) << 1) & continuation & ~ge_a0) |
+                                ((block.eq(0xED) << 1) & continuation & ge_a0) |
+                                ((block.eq(0xF0) << 1) & continuation & ~ge_90) |
+                                ((block.eq(0xF4) << 1) & continuation & ge_90);
+    const auto malformed =
+        ((expected ^ continuation) | bad_lead | second_invalid) & simd::full_mask;
+
+    // Stop before a sequence whose continuation bytes lie past the block.
+    const auto straddling = (lead2 & ~simd::low_bits(width - 1)) |
+                            (lead3 & ~simd::low_bits(width - 2)) |
+                            (lead4 & ~simd::low_bits(width - 3));
+    std::uint32_t limit = straddling != 0 ? std::countr_zero(straddling) : width;
+    if(malformed != 0) {
+        // Or at the last code point start before the first malformed byte, if earlier.
+        // Everything before it is well formed; the scalar decoder takes over from there.
+        const auto starts = ~continuation & simd::low_bits(std::countr_zero(malformed));
+        limit = std::min<std::uint32_t>(limit, starts != 0 ? 31 - std::countl_zero(starts) : 0);
+    }
+    const auto keep = simd::low_bits(limit);
+
+    const auto code_points = static_cast<std::uint32_t>(std::popcount(~continuation & keep));
+    const auto surrogates = static_cast<std::uint32_t>(std::popcount(lead4 & keep));
+    return {limit, code_points + surrogates, code_points};
+}
+
+// Moves a decode cursor through `text`. `index` is a code point boundary and `units` the
+// `encoding` units before it. The cursor advances over whole code points while they end at or
+// before byte `end`, and while the total stays at or below `max_units`. Code points are decoded
+// against all of `text`, so a sequence cut by `end` is left for the caller.
+inline void advance_cursor(std::string_view text,
+                           std::uint32_t& index,
+                           std::uint32_t& units,
+                           std::uint32_t end,
+                           std::uint32_t max_units,
+                           PositionEncoding encoding) {
+    assert(end <= text.size() && "cursor end out of range");
+    const bool utf16 = encoding == PositionEncoding::UTF16;
+
+    if(encoding == PositionEncoding::UTF8) {
+        const auto step = std::min(end - index, max_units - units);
+        index += step;
+        units += step;
+        return;
+    }
+
+    // Whole blocks until one would overshoot `max_units`; single code points after that.
+    bool blocks = true;
+    while(index < end) {
+        if(blocks && index + simd::block::width <= end) {
+            auto counted = scan_block(text.data() + index);
+            auto step = utf16 ? counted.utf16 : counted.utf32;
+            if(counted.bytes != 0 && step <= max_units - units) {
+                index += counted.bytes;
+                units += step;
+                continue;
+            }
+            blocks = counted.bytes == 0;
+        }
+
+        auto [utf8, utf16_units] = next_codepoint_sizes(text, index);
+        auto step = utf16 ? utf16_units : 1;
+        if(index + utf8 > end || step > max_units - units) {
+            return;
+        }
+        index += utf8;
+        units += step;
+    }
+}
+
+// Number of `encoding` code units in `text`.
+inline std::uint32_t measure_units(std::string_view text, PositionEncoding encoding) {
+    std::uint32_t index = 0;
+    std::uint32_t units = 0;
+    advance_cursor(text,
+                   index,
+                   units,
+                   static_cast<std::uint32_t>(text.size()),
+                   UINT32_MAX,
+                   encoding);
+    return units;
+}
+
+// Byte length of the prefix of `line` that spans `units` code units of `encoding`.
+// Returns std::nullopt when `units` ends inside a code point or past the end of `line`.
+inline std::optional<std::uint32_t> prefix_bytes(std::string_view line,
+                                                 std::uint32_t units,
+                                                 PositionEncoding encoding) {
+    std::uint32_t index = 0;
+    std::uint32_t counted = 0;
+    advance_cursor(line, index, counted, static_cast<std::uint32_t>(line.size()), units, encoding);
+    if(counted != units) [[unlikely]] {
+        return std::nullopt;
+    }
+    return index;
+}
+
+}  // namespace kota::ipc::lsp::detail
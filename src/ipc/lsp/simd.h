@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KOTA_LSP_SIMD_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define KOTA_LSP_SIMD_NEON 1
+#endif
+
+namespace kota::ipc::lsp::detail::simd {
+
+/// Fixed-width view of text bytes that answers per-byte comparisons as bitmasks: bit i of a
+/// result describes byte i. Picks AVX2, SSE2 or NEON at compile time; the scalar fallback
+/// computes the same masks a byte at a time.
+struct block {
+#if defined(__AVX2__)
+    constexpr static std::size_t width = 32;
+
+    explicit block(const char* data) noexcept :
+        bytes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))) {}
+
+    std::uint32_t eq(std::uint8_t value) const noexcept {
+        return mask(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(static_cast<char>(value))));
+    }
+
+    /// Bytes `>= value`, compared unsigned.
+    std::uint32_t ge(std::uint8_t value) const noexcept {
+        auto floor = _mm256_set1_epi8(static_cast<char>(value));
+        return mask(_mm256_cmpeq_epi8(_mm256_max_epu8(bytes, floor), bytes));
+    }
+
+private:
+    static std::uint32_t mask(__m256i lanes) noexcept {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(lanes));
+    }
+
+    __m256i bytes;
+#elif defined(KOTA_LSP_SIMD_SSE2)
+    constexpr static std::size_t width = 16;
+
+    explicit block(const char* data) noexcept :
+        bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))) {}
+
+    std::uint32_t eq(std::uint8_t value) const noexcept {
+        return mask(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value))));
+    }
+
+    /// Bytes `>= value`, compared unsigned.
+    std::uint32_t ge(std::uint8_t value) const noexcept {
+        auto floor = _mm_set1_epi8(static_cast<char>(value));
+        return mask(_mm_cmpeq_epi8(_mm_max_epu8(bytes, floor), bytes));
+    }
+
+private:
+    static std::uint32_t mask(__m128i lanes) noexcept {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(lanes));
+    }
+
+    __m128i bytes;
+#elif defined(KOTA_LSP_SIMD_NEON)
+    constexpr static std::size_t width = 16;
+
+    explicit block(const char* data) noexcept :
+        bytes(vld1q_u8(reinterpret_cast<const std::uint8_t*>(data))) {}
+
+    std::uint32_t eq(std::uint8_t value) const noexcept {
+        return mask(vceqq_u8(bytes, vdupq_n_u8(value)));
+    }
+
+    /// Bytes `>= value`, compared unsigned.
+    std::uint32_t ge(std::uint8_t value) const noexcept {
+        return mask(vcgeq_u8(bytes, vdupq_n_u8(value)));
+    }
+
+private:
+    // NEON has no movemask: keep one weight bit per lane and sum each half.
+    static std::uint32_t mask(uint8x16_t lanes) noexcept {
+        constexpr std::uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                              1, 2, 4, 8, 16, 32, 64, 128};
+        auto bits = vandq_u8(lanes, vld1q_u8(weights));
+        return static_cast<std::uint32_t>(vaddv_u8(vget_low_u8(bits))) |
+               (static_cast<std::uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+    }
+
+    uint8x16_t bytes;
+#else
+    constexpr static std::size_t width = 16;
+
+    explicit block(const char* data) noexcept {
+        std::memcpy(bytes, data, width);
+    }
+
+    std::uint32_t eq(std::uint8_t value) const noexcept {
+        std::uint32_t out = 0;
+        for(std::size_t i = 0; i < width; ++i) {
+            out |= static_cast<std::uint32_t>(bytes[i] == value) << i;
+        }
+        return out;
+    }
+
+    /// Bytes `>= value`, compared unsigned.
+    std::uint32_t ge(std::uint8_t value) const noexcept {
+        std::uint32_t out = 0;
+        for(std::size_t i = 0; i < width; ++i) {
+            out |= static_cast<std::uint32_t>(bytes[i] >= value) << i;
+        }
+        return out;
+    }
+
+private:
+    std::uint8_t bytes[width];
+#endif
+};
+
+/// Mask with the low `count` bits set; `count` may be the full 32.
+constexpr std::uint32_t low_bits(std::size_t count) noexcept {
+    return count >= 32 ? ~std::uint32_t(0) : (std::uint32_t(1) << count) - 1;
+}
+
+/// Mask of every byte in a block.
+constexpr std::uint32_t full_mask = low_bits(block::width);
+
+}  // namespace kota::ipc::lsp::detail::simd
+
+#undef KOTA_LSP_SIMD_SSE2
+#undef KOTA_LSP_SIMD_NEON
@@ -0,0 +1,406 @@
+#include "kota/ipc/lsp/text_document.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <variant>
+
+#include "codepoint.h"
+
+namespace kota::ipc::lsp {
+
+namespace detail {
+
+// One chunk of the rope, and the root of the subtree of chunks around it. The tree is a treap:
+// in-order traversal gives the text, and random priorities keep it balanced in expectation.
+struct rope_node {
+    std::string text;
+    std::uint32_t newlines = 0;
+    std::uint32_t priority = 0;
+
+    // Totals over the subtree rooted here.
+    std::uint32_t total_bytes = 0;
+    std::uint32_t total_newlines = 0;
+
+    std::unique_ptr<rope_node> left;
+    std::unique_ptr<rope_node> right;
+};
+
+}  // namespace detail
+
+namespace {
+
+using detail::rope_node;
+using node_ptr = std::unique_ptr<rope_node>;
+
+std::uint32_t bytes_of(const node_ptr& node) noexcept {
+    return node ? node->total_bytes : 0;
+}
+
+std::uint32_t newlines_of(const node_ptr& node) noexcept {
+    return node ? node->total_newlines : 0;
+}
+
+std::uint32_t count_newlines(std::string_view text) noexcept {
+    return static_cast<std::uint32_t>(std::ranges::count(text, '\n'));
+}
+
+void update(rope_node& node) noexcept {
+    node.total_bytes = bytes_of(node.left) + static_cast<std::uint32_t>(node.text.size()) +
+                       bytes_of(node.right);
+    node.total_newlines = newlines_of(node.left) + node.newlines + newlines_of(node.right);
+}
+
+// xorshift32; a fixed per-document sequence keeps the tree shape reproducible.
+std::uint32_t next_priority(std::uint32_t& seed) noexcept {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+node_ptr make_node(std::string text, std::uint32_t& seed) {
+    auto node = std::make_unique<rope_node>();
+    node->newlines = count_newlines(text);
+    node->text = std::move(text);
+    node->priority = next_priority(seed);
+    update(*node);
+    return node;
+}
+
+node_ptr merge(node_ptr left, node_ptr right) {
+    if(!left) {
+        return right;
+    }
+    if(!right) {
+        return left;
+    }
+
+    if(left->priority >= right->priority) {
+        left->right = merge(std::move(left->right), std::move(right));
+        update(*left);
+        return left;
+    }
+
+    right->left = merge(std::move(left), std::move(right->left));
+    update(*right);
+    return right;
+}
+
+// Splits into bytes [0, offset) and [offset, size). A chunk straddling `offset` is cut in two.
+std::pair<node_ptr, node_ptr> split(node_ptr node, std::uint32_t offset, std::uint32_t& seed) {
+    if(!node) {
+        return {};
+    }
+
+    const auto left_bytes = bytes_of(node->left);
+    if(offset <= left_bytes) {
+        auto [before, after] = split(std::move(node->left), offset, seed);
+        node->left = std::move(after);
+        update(*node);
+        return {std::move(before), std::move(node)};
+    }
+
+    offset -= left_bytes;
+    const auto own_bytes = static_cast<std::uint32_t>(node->text.size());
+    if(offset >= own_bytes) {
+        auto [before, after] = split(std::move(node->right), offset - own_bytes, seed);
+        node->right = std::move(before);
+        update(*node);
+        return {std::move(node), std::move(after)};
+    }
+
+    // The cut is inside this chunk: its tail becomes a new chunk heading the right part.
+    auto tail = make_node(node->text.substr(offset), seed);
+    node->text.resize(offset);
+    node->newlines -= tail->newlines;
+    auto right = std::move(node->right);
+    update(*node);
+    return {std::move(node), merge(std::move(tail), std::move(right))};
+}
+
+// Appends `text` to `tree` as chunks of at most TextDocument::chunk_bytes.
+node_ptr append_chunks(node_ptr tree, std::string_view text, std::uint32_t& seed) {
+    constexpr auto chunk_bytes = TextDocument::chunk_bytes;
+    if(text.empty()) {
+        return tree;
+    }
+
+    // Even pieces, so an edit that just overflows one chunk does not leave a sliver.
+    const auto pieces = (text.size() + chunk_bytes - 1) / chunk_bytes;
+    const auto piece_bytes = (text.size() + pieces - 1) / pieces;
+    while(!text.empty()) {
+        const auto size = std::min(text.size(), piece_bytes);
+        tree = merge(std::move(tree), make_node(std::string(text.substr(0, size)), seed));
+        text.remove_prefix(size);
+    }
+    return tree;
+}
+
+const rope_node* leftmost(const rope_node* node) noexcept {
+    while(node->left) {
+        node = node->left.get();
+    }
+    return node;
+}
+
+const rope_node* rightmost(const rope_node* node) noexcept {
+    while(node->right) {
+        node = node->right.get();
+    }
+    return node;
+}
+
+// Calls `fn(std::string_view)` for the parts of chunks overlapping [begin, end), in order.
+// `base` is the document offset of the subtree.
+template <typename Fn>
+void visit(const rope_node* node,
+           std::uint32_t base,
+           std::uint32_t begin,
+           std::uint32_t end,
+           const Fn& fn) {
+    if(!node || begin >= end) {
+        return;
+    }
+
+    const auto own_begin = base + bytes_of(node->left);
+    const auto own_end = own_begin + static_cast<std::uint32_t>(node->text.size());
+    if(begin < own_begin) {
+        visit(node->left.get(), base, begin, end, fn);
+    }
+
+    const auto from = std::max(begin, own_begin);
+    const auto to = std::min(end, own_end);
+    if(from < to) {
+        fn(std::string_view(node->text).substr(from - own_begin, to - from));
+    }
+
+    if(end > own_end) {
+        visit(node->right.get(), own_end, begin, end, fn);
+    }
+}
+
+}  // namespace
+
+TextDocument::TextDocument(std::string_view content, PositionEncoding encoding) :
+    encoding(encoding), seed(0x9E3779B9u) {
+    root = append_chunks(nullptr, content, seed);
+}
+
+TextDocument::TextDocument(TextDocument&& other) noexcept = default;
+
+TextDocument& TextDocument::operator=(TextDocument&& other) noexcept = default;
+
+TextDocument::~TextDocument() = default;
+
+std::uint32_t TextDocument::size() const noexcept {
+    return bytes_of(root);
+}
+
+std::uint32_t TextDocument::line_count() const noexcept {
+    return newlines_of(root) + 1;
+}
+
+std::uint32_t TextDocument::line_of(std::uint32_t offset) const {
+    assert(offset <= size() && "offset out of range");
+
+    // Count the newlines before `offset`.
+    std::uint32_t line = 0;
+    const rope_node* node = root.get();
+    while(node) {
+        const auto left_bytes = bytes_of(node->left);
+        if(offset <= left_bytes) {
+            node = node->left.get();
+            continue;
+        }
+
+        offset -= left_bytes;
+        line += newlines_of(node->left);
+        if(offset <= node->text.size()) {
+            line += count_newlines(std::string_view(node->text).substr(0, offset));
+            break;
+        }
+
+        offset -= static_cast<std::uint32_t>(node->text.size());
+        line += node->newlines;
+        node = node->right.get();
+    }
+    return line;
+}
+
+std::uint32_t TextDocument::line_start(std::uint32_t line) const {
+    assert(line < line_count() && "line out of range");
+    if(line == 0) {
+        return 0;
+    }
+
+    // Find the `line`-th newline; the line starts right after it.
+    std::uint32_t base = 0;
+    const rope_node* node = root.get();
+    while(node) {
+        const auto left_newlines = newlines_of(node->left);
+        if(line <= left_newlines) {
+            node = node->left.get();
+            continue;
+        }
+
+        line -= left_newlines;
+        base += bytes_of(node->left);
+        if(line <= node->newlines) {
+            std::size_t at = 0;
+            for(std::uint32_t seen = 0;; ++at) {
+                if(node->text[at] == '\n' && ++seen == line) {
+                    break;
+                }
+            }
+            return base + static_cast<std::uint32_t>(at) + 1;
+        }
+
+        line -= node->newlines;
+        base += static_cast<std::uint32_t>(node->text.size());
+        node = node->right.get();
+    }
+
+    assert(false && "newline counts out of sync");
+    return size();
+}
+
+std::uint32_t TextDocument::line_end_exclusive(std::uint32_t line) const {
+    assert(line < line_count() && "line out of range");
+    if(line + 1 < line_count()) {
+        return line_start(line + 1) - 1;
+    }
+    return size();
+}
+
+std::optional<protocol::Position> TextDocument::to_position(std::uint32_t offset) const {
+    if(offset > size()) [[unlikely]] {
+        return std::nullopt;
+    }
+
+    auto line = line_of(offset);
+    auto begin = line_start(line);
+    std::string scratch;
+    return protocol::Position{
+        .line = line,
+        .character = detail::measure_units(slice(begin, offset, scratch), encoding),
+    };
+}
+
+std::optional<std::uint32_t> TextDocument::to_offset(protocol::Position position) const {
+    if(position.line >= line_count()) [[unlikely]] {
+        return std::nullopt;
+    }
+
+    auto begin = line_start(position.line);
+    if(position.character == 0) {
+        return begin;
+    }
+
+    std::string scratch;
+    auto line = slice(begin, line_end_exclusive(position.line), scratch);
+    auto column = detail::prefix_bytes(line, position.character, encoding);
+    if(!column) [[unlikely]] {
+        return std::nullopt;
+    }
+    return begin + *column;
+}
+
+std::string TextDocument::text(std::uint32_t begin, std::uint32_t end) const {
+    assert(begin <= end && end <= size() && "range out of bounds");
+    std::string out;
+    out.reserve(end - begin);
+    visit(root.get(), 0, begin, end, [&](std::string_view part) { out.append(part); });
+    return out;
+}
+
+std::string TextDocument::text() const {
+    return text(0, size());
+}
+
+void TextDocument::replace(std::uint32_t begin, std::uint32_t end, std::string_view replacement) {
+    assert(begin <= end && end <= size() && "range out of bounds");
+
+    auto [left, rest] = split(std::move(root), begin, seed);
+    auto [removed, right] = split(std::move(rest), end - begin, seed);
+    removed.reset();
+
+    // Fold the chunks on either side into the new text, so repeated small edits at one spot
+    // keep reusing a chunk instead of piling up tiny ones.
+    std::string merged;
+    if(left) {
+        const auto tail_start =
+            bytes_of(left) - static_cast<std::uint32_t>(rightmost(left.get())->text.size());
+        auto [kept, tail] = split(std::move(left), tail_start, seed);
+        left = std::move(kept);
+        merged = std::move(tail->text);
+    }
+    merged.append(replacement);
+    if(right) {
+        const auto head_bytes = static_cast<std::uint32_t>(leftmost(right.get())->text.size());
+        auto [head, kept] = split(std::move(right), head_bytes, seed);
+        right = std::move(kept);
+        merged.append(head->text);
+    }
+
+    root = merge(append_chunks(std::move(left), merged, seed), std::move(right));
+}
+
+std::optional<std::uint32_t> TextDocument::resolve(protocol::Position position) const {
+    if(position.line >= line_count()) {
+        return size();
+    }
+
+    auto begin = line_start(position.line);
+    auto end = line_end_exclusive(position.line);
+    std::string scratch;
+    auto line = slice(begin, end, scratch);
+    if(auto column = detail::prefix_bytes(line, position.character, encoding)) {
+        return begin + *column;
+    }
+    if(position.character > detail::measure_units(line, encoding)) {
+        return end;
+    }
+    return std::nullopt;
+}
+
+bool TextDocument::apply(const protocol::TextDocumentContentChangeEvent& change) {
+    if(auto* whole = std::get_if<protocol::TextDocumentContentChangeWholeDocument>(&change)) {
+        root = append_chunks(nullptr, whole->text, seed);
+        return true;
+    }
+
+    const auto& partial = std::get<protocol::TextDocumentContentChangePartial>(change);
+    auto begin = resolve(partial.range.start);
+    auto end = resolve(partial.range.end);
+    if(!begin || !end || *begin > *end) [[unlikely]] {
+        return false;
+    }
+
+    replace(*begin, *end, partial.text);
+    return true;
+}
+
+bool TextDocument::apply(std::span<const protocol::TextDocumentContentChangeEvent> changes) {
+    return std::ranges::all_of(changes, [&](const auto& change) { return apply(change); });
+}
+
+std::string_view TextDocument::slice(std::uint32_t begin,
+                                     std::uint32_t end,
+                                     std::string& scratch) const {
+    std::string_view single;
+    std::size_t parts = 0;
+    visit(root.get(), 0, begin, end, [&](std::string_view part) {
+        if(++parts == 1) {
+            single = part;
+            return;
+        }
+        if(parts == 2) {
+            scratch.assign(single);
+        }
+        scratch.append(part);
+    });
+    return parts > 1 ? std::string_view(scratch) : single;
+}
+
+}  // namespace kota::ipc::lsp
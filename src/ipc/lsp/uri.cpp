@@ -1,12 +1,45 @@
 #include "kota/ipc/lsp/uri.h"
 
 #include <algorithm>
+#include <functional>
+#include <mutex>
 #include <ranges>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace kota::ipc::lsp {
 
+namespace detail {
+
+// Lets the path map be probed with a string_view without building a key string.
+struct transparent_string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view text) const noexcept {
+        return std::hash<std::string_view>{}(text);
+    }
+};
+
+struct uri_shard {
+    mutable std::shared_mutex mutex;
+
+    // Keys view the entry's own `text`, which never moves.
+    std::unordered_map<std::string_view, std::unique_ptr<InternedURI>> by_text;
+
+    std::unordered_map<std::string, const InternedURI*, transparent_string_hash, std::equal_to<>>
+        by_path;
+};
+
+}  // namespace detail
+
 namespace {
 
+constexpr std::size_t uri_shard_count = 16;
+
+std::size_t shard_of(std::string_view key) noexcept {
+    return std::hash<std::string_view>{}(key) % uri_shard_count;
+}
+
 constexpr bool is_ascii_alpha(unsigned char value) noexcept {
     return (value >= 'A' && value <= 'Z') || (value >= 'a' && value <= 'z');
 }
@@ -463,4 +496,69 @@ std::expected<std::string, std::string> URI::file_path() const {
     return *decoded_path;
 }
 
+URIInterner::URIInterner() : shards(std::make_unique<detail::uri_shard[]>(uri_shard_count)) {}
+
+URIInterner::~URIInterner() = default;
+
+std::expected<const InternedURI*, std::string> URIInterner::intern(std::string_view text) {
+    auto& shard = shards[shard_of(text)];
+    {
+        std::shared_lock lock(shard.mutex);
+        if(auto it = shard.by_text.find(text); it != shard.by_text.end()) [[likely]] {
+            return it->second.get();
+        }
+    }
+
+    // Parse outside the lock; if another thread interns the same text meanwhile, its entry
+    // wins and this one is dropped.
+    auto uri = URI::parse(text);
+    if(!uri) [[unlikely]] {
+        return std::unexpected(std::move(uri.error()));
+    }
+    auto file_path = uri->file_path();
+    auto entry = std::make_unique<InternedURI>(InternedURI{
+        .text = std::string(text),
+        .uri = std::move(*uri),
+        .file_path = std::move(file_path),
+    });
+
+    std::unique_lock lock(shard.mutex);
+    std::string_view key = entry->text;
+    auto it = shard.by_text.try_emplace(key, std::move(entry)).first;
+    return it->second.get();
+}
+
+std::expected<const InternedURI*, std::string>
+    URIInterner::intern_file_path(std::string_view path) {
+    auto& shard = shards[shard_of(path)];
+    {
+        std::shared_lock lock(shard.mutex);
+        if(auto it = shard.by_path.find(path); it != shard.by_path.end()) [[likely]] {
+            return it->second;
+        }
+    }
+
+    auto uri = URI::from_file_path(path);
+    if(!uri) [[unlikely]] {
+        return std::unexpected(std::move(uri.error()));
+    }
+    auto entry = intern(uri->str());
+    if(!entry) [[unlikely]] {
+        return entry;
+    }
+
+    std::unique_lock lock(shard.mutex);
+    shard.by_path.try_emplace(std::string(path), *entry);
+    return entry;
+}
+
+std::size_t URIInterner::size() const {
+    std::size_t count = 0;
+    for(std::size_t index = 0; index < uri_shard_count; ++index) {
+        std::shared_lock lock(shards[index].mutex);
+        count += shards[index].by_text.size();
+    }
+    return count;
+}
+
 }  // namespace kota::ipc::lsp
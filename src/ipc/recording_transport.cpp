@@ -1,28 +1,186 @@
 #include "kota/ipc/recording_transport.h"
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <format>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 namespace kota::ipc {
 
-RecordingTransport::RecordingTransport(std::unique_ptr<Transport> transport, std::string path) :
-    inner(std::move(transport)), file(std::fopen(path.c_str(), "wb")),
-    start(std::chrono::steady_clock::now()) {
-    assert(inner && "RecordingTransport requires a non-null inner transport");
-    // If fopen fails, keep transport functional; write_record() no-ops on null file.
+namespace {
+
+// Escaped lines are written out whenever this many have piled up, so escaping (which can
+// grow a payload sixfold) never holds a whole batch's worth of output in memory.
+constexpr std::size_t line_flush_bytes = 64 * 1024;
+
+// Prefix of each record in the pending buffer; the raw payload follows.
+struct record_header {
+    std::int64_t ms;
+    std::uint64_t size;
+};
+
+void append_record_line(std::string& line, std::int64_t ms, std::string_view payload) {
+    line.append(std::format(R"({{"ts":{},"msg":")", ms));
+    for(unsigned char uc: payload) {
+        switch(uc) {
+            case '"': line.append(R"(\")"); break;
+            case '\\': line.append(R"(\\)"); break;
+            case '\b': line.append(R"(\b)"); break;
+            case '\f': line.append(R"(\f)"); break;
+            case '\n': line.append(R"(\n)"); break;
+            case '\r': line.append(R"(\r)"); break;
+            case '\t': line.append(R"(\t)"); break;
+            default:
+                if(uc < 0x20) {
+                    line.append(std::format("\\u{:04X}", uc));
+                } else {
+                    line.push_back(static_cast<char>(uc));
+                }
+                break;
+        }
+    }
+    line.append("\"}\n");
 }
 
-RecordingTransport::~RecordingTransport() {
-    if(file) {
+}  // namespace
+
+// Double buffer between the loop thread, which appends raw records to `pending`, and a
+// writer thread, which swaps `pending` out and escapes and writes the batch in pieces.
+struct RecordingTransport::Writer {
+    std::FILE* file;
+    std::size_t max_buffered_bytes;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::string pending;
+    // Size of the batch the writer thread is still working through; it counts against
+    // `max_buffered_bytes` together with `pending`.
+    std::size_t writing = 0;
+    bool stopping = false;
+
+    std::atomic<std::uint64_t> dropped{0};
+    // Set by the writer thread once the file fails; later records are discarded.
+    std::atomic<bool> failed{false};
+
+    std::thread thread;
+
+    Writer(std::FILE* file, std::size_t max_buffered_bytes) :
+        file(file), max_buffered_bytes(max_buffered_bytes), thread([this] { run(); }) {}
+
+    ~Writer() {
+        stop();
+    }
+
+    void append(std::int64_t ms, std::string_view payload) {
+        if(failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const record_header header{ms, payload.size()};
+        bool was_empty = false;
+        {
+            std::lock_guard guard(lock);
+            if(stopping) {
+                return;
+            }
+            if(pending.size() + writing + sizeof(header) + payload.size() > max_buffered_bytes) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            was_empty = pending.empty();
+            pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            pending.append(payload);
+        }
+
+        // The writer only sleeps on an empty buffer.
+        if(was_empty) {
+            wake.notify_one();
+        }
+    }
+
+    // Drain whatever is buffered, then close the file.
+    void stop() {
+        if(!thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
         std::fclose(file);
     }
+
+    void run() {
+        std::string batch;
+        std::string lines;
+        while(true) {
+            {
+                std::unique_lock guard(lock);
+                wake.wait(guard, [&] { return stopping || !pending.empty(); });
+                if(pending.empty()) {
+                    return;
+                }
+                batch.swap(pending);
+                writing = batch.size();
+            }
+
+            for(std::size_t pos = 0; pos < batch.size();) {
+                record_header header;
+                std::memcpy(&header, batch.data() + pos, sizeof(header));
+                pos += sizeof(header);
+                auto payload = std::string_view(batch).substr(pos, header.size);
+                append_record_line(lines, header.ms, payload);
+                pos += header.size;
+                if(lines.size() >= line_flush_bytes) {
+                    write_lines(lines);
+                }
+            }
+            write_lines(lines);
+            if(!failed.load(std::memory_order_relaxed) && std::fflush(file) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+            batch.clear();
+
+            std::lock_guard guard(lock);
+            writing = 0;
+        }
+    }
+
+    // Writes out and clears `lines`; once the file has failed they are only cleared.
+    void write_lines(std::string& lines) {
+        if(!lines.empty() && !failed.load(std::memory_order_relaxed)) {
+            if(std::fwrite(lines.data(), 1, lines.size(), file) != lines.size()) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        lines.clear();
+    }
+};
+
+RecordingTransport::RecordingTransport(std::unique_ptr<Transport> transport,
+                                       std::string path,
+                                       recording_options options) :
+    inner(std::move(transport)), start(std::chrono::steady_clock::now()) {
+    assert(inner && "RecordingTransport requires a non-null inner transport");
+    // If fopen fails, keep transport functional; write_record() no-ops without a writer.
+    if(auto* file = std::fopen(path.c_str(), "wb")) {
+        writer = std::make_unique<Writer>(file, options.max_buffered_bytes);
+    }
 }
 
-task<std::optional<std::string>> RecordingTransport::read_message() {
+RecordingTransport::~RecordingTransport() = default;
+
+task<std::optional<MessageBuffer>> RecordingTransport::read_message() {
     auto msg = co_await inner->read_message();
     if(msg.has_value()) {
-        write_record(*msg);
+        write_record(msg->view());
     }
     co_return msg;
 }
@@ -31,52 +189,32 @@ task<void, Error> RecordingTransport::write_message(std::string_view payload) {
     co_await inner->write_message(payload);
 }
 
+task<void, Error> RecordingTransport::write_messages(std::span<const std::string> payloads) {
+    co_await inner->write_messages(payloads).or_fail();
+}
+
 Result<void> RecordingTransport::close_output() {
     return inner->close_output();
 }
 
 Result<void> RecordingTransport::close() {
-    if(file) {
-        std::fclose(file);
-        file = nullptr;
+    if(writer) {
+        writer->stop();
     }
     return inner->close();
 }
 
+std::uint64_t RecordingTransport::dropped_records() const noexcept {
+    return writer ? writer->dropped.load(std::memory_order_relaxed) : 0;
+}
+
 void RecordingTransport::write_record(std::string_view payload) {
-    if(!file) {
+    if(!writer) {
         return;
     }
     auto elapsed = std::chrono::steady_clock::now() - start;
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
-
-    std::string line;
-    line.reserve(payload.size() + 64);
-    line.append(std::format(R"({{"ts":{},"msg":")", ms));
-    for(unsigned char uc: payload) {
-        switch(uc) {
-            case '"': line.append(R"(\")"); break;
-            case '\\': line.append(R"(\\)"); break;
-            case '\b': line.append(R"(\b)"); break;
-            case '\f': line.append(R"(\f)"); break;
-            case '\n': line.append(R"(\n)"); break;
-            case '\r': line.append(R"(\r)"); break;
-            case '\t': line.append(R"(\t)"); break;
-            default:
-                if(uc < 0x20) {
-                    line.append(std::format("\\u{:04X}", uc));
-                } else {
-                    line.push_back(static_cast<char>(uc));
-                }
-                break;
-        }
-    }
-    line.append("\"}\n");
-    auto written = std::fwrite(line.data(), 1, line.size(), file);
-    if(written != line.size() || std::fflush(file) != 0) {
-        std::fclose(file);
-        file = nullptr;
-    }
+    writer->append(static_cast<std::int64_t>(ms), payload);
 }
 
 }  // namespace kota::ipc
@@ -0,0 +1,383 @@
+#include "kota/ipc/replay_transport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <utility>
+
+namespace kota::ipc {
+
+namespace {
+
+using replay_clock = std::chrono::steady_clock;
+
+// While draining, how often to look for the last responses.
+constexpr std::chrono::milliseconds drain_poll_interval{5};
+
+void skip_whitespace(std::string_view text, std::size_t& pos) {
+    while(pos < text.size() &&
+          (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+        ++pos;
+    }
+}
+
+bool expect(std::string_view text, std::size_t& pos, char ch) {
+    skip_whitespace(text, pos);
+    if(pos >= text.size() || text[pos] != ch) {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+void append_utf8(std::string& out, std::uint32_t code) {
+    if(code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if(code < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if(code < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+}
+
+std::optional<std::uint32_t> parse_hex4(std::string_view text, std::size_t pos) {
+    std::uint32_t value = 0;
+    if(pos + 4 > text.size() ||
+       std::from_chars(text.data() + pos, text.data() + pos + 4, value, 16).ptr !=
+           text.data() + pos + 4) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Parse the JSON string starting at `pos` (at its opening quote) into `out`, unescaped.
+bool parse_string(std::string_view text, std::size_t& pos, std::string& out) {
+    if(!expect(text, pos, '"')) {
+        return false;
+    }
+
+    while(pos < text.size()) {
+        auto end = text.find_first_of("\"\\", pos);
+        if(end == std::string_view::npos) {
+            return false;
+        }
+        out.append(text.substr(pos, end - pos));
+        pos = end + 1;
+        if(text[end] == '"') {
+            return true;
+        }
+
+        if(pos >= text.size()) {
+            return false;
+        }
+        switch(text[pos++]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                auto code = parse_hex4(text, pos);
+                if(!code) {
+                    return false;
+                }
+                pos += 4;
+                // A high surrogate followed by an escaped low surrogate is one code point.
+                if(*code >= 0xd800 && *code < 0xdc00 && text.substr(pos, 2) == "\\u") {
+                    auto low = parse_hex4(text, pos + 2);
+                    if(low && *low >= 0xdc00 && *low < 0xe000) {
+                        *code = 0x10000 + ((*code - 0xd800) << 10) + (*low - 0xdc00);
+                        pos += 6;
+                    }
+                }
+                append_utf8(out, *code);
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;
+}
+
+// Parse one RecordingTransport line: {"ts":<ms>,"msg":"<escaped payload>"}.
+std::optional<std::pair<std::int64_t, std::string>> parse_trace_line(std::string_view line) {
+    std::size_t pos = 0;
+    if(!expect(line, pos, '{')) {
+        return std::nullopt;
+    }
+
+    std::optional<std::int64_t> ts;
+    std::optional<std::string> msg;
+    std::string key;
+    while(true) {
+        key.clear();
+        if(!parse_string(line, pos, key) || !expect(line, pos, ':')) {
+            return std::nullopt;
+        }
+        skip_whitespace(line, pos);
+
+        if(key == "ts") {
+            std::int64_t value = 0;
+            auto [end, ec] = std::from_chars(line.data() + pos, line.data() + line.size(), value);
+            if(ec != std::errc{}) {
+                return std::nullopt;
+            }
+            pos = static_cast<std::size_t>(end - line.data());
+            ts = value;
+        } else if(key == "msg") {
+            msg.emplace();
+            if(!parse_string(line, pos, *msg)) {
+                return std::nullopt;
+            }
+        } else {
+            return std::nullopt;
+        }
+
+        skip_whitespace(line, pos);
+        if(pos < line.size() && line[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        if(!expect(line, pos, '}') || !ts || !msg) {
+            return std::nullopt;
+        }
+        return std::pair{*ts, std::move(*msg)};
+    }
+}
+
+// Skip the JSON value at `pos` without interpreting it.
+bool skip_value(std::string_view text, std::size_t& pos) {
+    skip_whitespace(text, pos);
+    std::size_t depth = 0;
+    while(pos < text.size()) {
+        const char ch = text[pos++];
+        if(ch == '"') {
+            while(pos < text.size() && text[pos] != '"') {
+                pos += text[pos] == '\\' ? 2 : 1;
+            }
+            if(pos++ >= text.size()) {
+                return false;
+            }
+        } else if(ch == '{' || ch == '[') {
+            ++depth;
+        } else if(ch == '}' || ch == ']') {
+            if(depth == 0) {
+                --pos;
+                return true;
+            }
+            --depth;
+        } else if(ch == ',' && depth == 0) {
+            --pos;
+            return true;
+        }
+
+        if(depth == 0 && (ch == '"' || ch == '}' || ch == ']')) {
+            return true;
+        }
+    }
+    return depth == 0;
+}
+
+// The parts of a JSON-RPC envelope replay cares about: the raw text of a top-level "id", and
+// whether a top-level "method" is present.
+struct envelope {
+    std::string_view id;
+    bool has_method = false;
+};
+
+envelope scan_envelope(std::string_view payload) {
+    envelope out;
+    std::size_t pos = 0;
+    if(!expect(payload, pos, '{')) {
+        return out;
+    }
+
+    std::string key;
+    while(true) {
+        key.clear();
+        if(!parse_string(payload, pos, key) || !expect(payload, pos, ':')) {
+            return out;
+        }
+        skip_whitespace(payload, pos);
+
+        const auto start = pos;
+        if(!skip_value(payload, pos)) {
+            return out;
+        }
+        if(key == "id") {
+            out.id = payload.substr(start, pos - start);
+            out.id = out.id.substr(0, out.id.find_last_not_of(" \t\r\n") + 1);
+        } else if(key == "method") {
+            out.has_method = true;
+        }
+
+        if(!expect(payload, pos, ',')) {
+            return out;
+        }
+    }
+}
+
+}  // namespace
+
+ReplayTransport::ReplayTransport(std::vector<record> records,
+                                 replay_options options,
+                                 event_loop& loop) :
+    records(std::move(records)), options(options), loop(loop) {}
+
+Result<std::unique_ptr<ReplayTransport>>
+    ReplayTransport::open(const std::string& path, replay_options options, event_loop& loop) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        return outcome_error(Error("cannot open trace: " + path));
+    }
+
+    std::vector<std::string> lines;
+    for(std::string line; std::getline(file, line);) {
+        lines.push_back(std::move(line));
+    }
+    if(file.bad()) {
+        return outcome_error(Error("cannot read trace: " + path));
+    }
+
+    std::vector<std::string_view> views(lines.begin(), lines.end());
+    return from_lines(views, options, loop);
+}
+
+Result<std::unique_ptr<ReplayTransport>>
+    ReplayTransport::from_lines(std::span<const std::string_view> lines,
+                                replay_options options,
+                                event_loop& loop) {
+    std::vector<record> records;
+    records.reserve(lines.size());
+
+    std::optional<std::int64_t> first_ts;
+    for(std::size_t i = 0; i < lines.size(); ++i) {
+        auto line = lines[i];
+        if(line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+        }
+
+        auto parsed = parse_trace_line(line);
+        if(!parsed) {
+            return outcome_error(Error("malformed trace line " + std::to_string(i + 1)));
+        }
+
+        // Times are kept relative to the first message, and never run backwards.
+        if(!first_ts) {
+            first_ts = parsed->first;
+        }
+        auto at = std::chrono::milliseconds(std::max<std::int64_t>(parsed->first - *first_ts, 0));
+        if(!records.empty()) {
+            at = std::max(at, records.back().at);
+        }
+        records.push_back(record{at, std::move(parsed->second)});
+    }
+
+    return std::unique_ptr<ReplayTransport>(
+        new ReplayTransport(std::move(records), options, loop));
+}
+
+task<std::optional<MessageBuffer>> ReplayTransport::read_message() {
+    if(closed) {
+        co_return std::nullopt;
+    }
+
+    if(next == records.size()) {
+        // Give the server a chance to answer what was sent before reporting end of input.
+        const auto deadline = replay_clock::now() + options.drain_timeout;
+        while(!closed && !outstanding.empty() && replay_clock::now() < deadline) {
+            co_await sleep(drain_poll_interval, loop);
+        }
+        finish();
+        co_return std::nullopt;
+    }
+
+    if(next == 0) {
+        started = replay_clock::now();
+        last_activity = started;
+    }
+
+    const auto& current = records[next++];
+    if(options.speed > 0) {
+        const auto offset = std::chrono::duration<double, std::milli>(
+            static_cast<double>(current.at.count()) / options.speed);
+        const auto due = started + std::chrono::duration_cast<replay_clock::duration>(offset);
+        const auto now = replay_clock::now();
+        if(due > now) {
+            co_await sleep(std::chrono::ceil<std::chrono::milliseconds>(due - now), loop);
+        }
+    }
+    if(closed) {
+        co_return std::nullopt;
+    }
+
+    const auto sent = replay_clock::now();
+    last_activity = sent;
+    totals.bytes_in += current.payload.size();
+
+    auto message = scan_envelope(current.payload);
+    if(message.has_method) {
+        if(message.id.empty()) {
+            ++totals.notifications;
+        } else {
+            ++totals.requests;
+            outstanding.insert_or_assign(std::string(message.id), sent);
+        }
+    }
+
+    co_return MessageBuffer(current.payload);
+}
+
+task<void, Error> ReplayTransport::write_message(std::string_view payload) {
+    totals.bytes_out += payload.size();
+
+    auto message = scan_envelope(payload);
+    if(message.has_method || message.id.empty()) {
+        co_return;
+    }
+
+    auto it = outstanding.find(std::string(message.id));
+    if(it == outstanding.end()) {
+        co_return;
+    }
+
+    const auto now = replay_clock::now();
+    totals.latency.record(now - it->second);
+    ++totals.responses;
+    last_activity = now;
+    outstanding.erase(it);
+}
+
+Result<void> ReplayTransport::close_output() {
+    return {};
+}
+
+Result<void> ReplayTransport::close() {
+    if(!closed) {
+        closed = true;
+        finish();
+    }
+    return {};
+}
+
+void ReplayTransport::finish() {
+    totals.unanswered = outstanding.size();
+    if(next != 0) {
+        totals.elapsed = last_activity - started;
+    }
+}
+
+}  // namespace kota::ipc
@@ -0,0 +1,558 @@
+#include "kota/ipc/shm_transport.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define KOTA_IPC_HAS_SHM_TRANSPORT 1
+#endif
+
+namespace kota::ipc {
+
+#if defined(KOTA_IPC_HAS_SHM_TRANSPORT)
+
+namespace {
+
+constexpr std::uint64_t region_magic = 0x6b6f74612d73686dULL;  // "kota-shm"
+constexpr std::size_t min_ring_bytes = 4096;
+constexpr std::size_t max_ring_bytes = std::size_t(1) << 30;
+constexpr std::size_t max_payload_bytes = 64 * 1024 * 1024;
+constexpr std::size_t frame_header_bytes = 4;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+// Control block for one direction. `head` and `tail` are running byte counts; the producer
+// only stores `head` and the consumer only stores `tail`, each on its own cache line.
+struct ring_control {
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+    alignas(64) std::atomic<std::uint32_t> reader_waiting{0};
+    std::atomic<std::uint32_t> writer_waiting{0};
+    std::atomic<std::uint32_t> closed{0};
+};
+
+// Start of the mapping; the two rings' data follows, ring 0 first. The creator writes ring 0
+// and reads ring 1.
+struct region_header {
+    std::uint64_t magic = region_magic;
+    std::uint64_t ring_bytes = 0;
+    // Number of sides that have opened the region; the first one writes ring 0.
+    std::atomic<std::uint32_t> attached{0};
+    ring_control rings[2];
+};
+
+constexpr std::size_t data_offset = (sizeof(region_header) + 63) / 64 * 64;
+
+std::size_t region_size(std::size_t ring_bytes) {
+    return data_offset + 2 * ring_bytes;
+}
+
+Error errno_error(std::string_view what) {
+    return Error(std::string(what) + ": " + std::strerror(errno));
+}
+
+int create_memory_fd() {
+#if defined(__linux__)
+    return ::memfd_create("kota-ipc", MFD_CLOEXEC);
+#else
+    // No memfd: create a uniquely named POSIX shm object and unlink it straight away, so only
+    // the descriptor keeps it alive.
+    for(int attempt = 0; attempt < 16; ++attempt) {
+        auto name = "/kota-ipc-" + std::to_string(::getpid()) + "-" +
+                    std::to_string(reinterpret_cast<std::uintptr_t>(&attempt) ^ attempt);
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if(fd >= 0) {
+            ::shm_unlink(name.c_str());
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            return fd;
+        }
+        if(errno != EEXIST) {
+            break;
+        }
+    }
+    return -1;
+#endif
+}
+
+// Copy into / out of a power-of-two ring at running offset `pos`, wrapping at the end.
+void copy_to_ring(std::byte* ring,
+                  std::size_t capacity,
+                  std::uint64_t pos,
+                  const char* src,
+                  std::size_t n) {
+    const auto offset = static_cast<std::size_t>(pos & (capacity - 1));
+    const auto first = std::min(n, capacity - offset);
+    std::memcpy(ring + offset, src, first);
+    std::memcpy(ring, src + first, n - first);
+}
+
+void copy_from_ring(const std::byte* ring,
+                    std::size_t capacity,
+                    std::uint64_t pos,
+                    char* dst,
+                    std::size_t n) {
+    const auto offset = static_cast<std::size_t>(pos & (capacity - 1));
+    const auto first = std::min(n, capacity - offset);
+    std::memcpy(dst, ring + offset, first);
+    std::memcpy(dst + first, ring, n - first);
+}
+
+}  // namespace
+
+struct SharedMemoryTransport::Self {
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::size_t capacity = 0;
+
+    ring_control* out = nullptr;
+    ring_control* in = nullptr;
+    std::byte* out_data = nullptr;
+    std::byte* in_data = nullptr;
+
+    // Local copies of the counters this side owns.
+    std::uint64_t out_head = 0;
+    std::uint64_t in_tail = 0;
+
+    stream doorbell;
+    int doorbell_fd = -1;
+    bool doorbell_reading = false;
+    bool peer_gone = false;
+    bool closed = false;
+    bool output_closed = false;
+    event doorbell_rung;
+    mutex write_lock;
+
+    ~Self() {
+        if(mapping != nullptr) {
+            ::munmap(mapping, mapping_size);
+        }
+    }
+
+    void ring_doorbell() {
+        if(doorbell_fd < 0 || peer_gone) {
+            return;
+        }
+        // A full socket buffer means the peer already has wakeups pending, so EAGAIN is fine.
+        const char byte = 1;
+        int flags = MSG_DONTWAIT;
+#if defined(MSG_NOSIGNAL)
+        flags |= MSG_NOSIGNAL;
+#endif
+        [[maybe_unused]] auto sent = ::send(doorbell_fd, &byte, 1, flags);
+    }
+
+    void close_output() {
+        if(!output_closed) {
+            output_closed = true;
+            out->closed.store(1, std::memory_order_seq_cst);
+            ring_doorbell();
+        }
+    }
+
+    void close() {
+        if(closed) {
+            return;
+        }
+
+        close_output();
+        closed = true;
+        doorbell.stop();
+        doorbell = stream{};
+        doorbell_fd = -1;
+        doorbell_rung.set();
+        doorbell_rung.reset();
+    }
+
+    // Sleep until the peer rings. Whichever side gets here first reads the socket; the other
+    // waits on `doorbell_rung`. Everyone woken re-checks its ring. Returns false once the peer
+    // has hung up or the transport is closed.
+    task<bool> wait_doorbell() {
+        if(peer_gone || closed) {
+            co_return false;
+        }
+        if(doorbell_reading) {
+            co_await doorbell_rung.wait();
+            co_return !peer_gone && !closed;
+        }
+
+        doorbell_reading = true;
+        auto chunk = co_await doorbell.read_chunk();
+        doorbell_reading = false;
+        if(chunk) {
+            doorbell.consume(chunk->size());
+        } else {
+            peer_gone = true;
+        }
+
+        doorbell_rung.set();
+        doorbell_rung.reset();
+        co_return !peer_gone && !closed;
+    }
+
+    // Copy `n` bytes out of the incoming ring, sleeping while it is empty. Returns false at
+    // end of input.
+    task<bool> pull(char* dst, std::size_t n) {
+        while(n != 0) {
+            if(closed) {
+                co_return false;
+            }
+
+            // The peer owns `head`, so a value behind our tail or more than a ring ahead of it
+            // means the region is corrupt; reading on would run past the mapping.
+            auto available = in->head.load(std::memory_order_acquire) - in_tail;
+            if(available > capacity) {
+                close();
+                co_return false;
+            }
+            if(available == 0) {
+                in->reader_waiting.store(1, std::memory_order_seq_cst);
+                available = in->head.load(std::memory_order_seq_cst) - in_tail;
+                if(available > capacity) {
+                    close();
+                    co_return false;
+                }
+                if(available == 0) {
+                    if(in->closed.load(std::memory_order_acquire) != 0 &&
+                       in->head.load(std::memory_order_acquire) == in_tail) {
+                        co_return false;
+                    }
+                    if(!co_await wait_doorbell() &&
+                       in->head.load(std::memory_order_acquire) == in_tail) {
+                        co_return false;
+                    }
+                    continue;
+                }
+                in->reader_waiting.store(0, std::memory_order_relaxed);
+            }
+
+            const auto take = static_cast<std::size_t>(std::min<std::uint64_t>(available, n));
+            copy_from_ring(in_data, capacity, in_tail, dst, take);
+            in_tail += take;
+            in->tail.store(in_tail, std::memory_order_seq_cst);
+            if(in->writer_waiting.exchange(0, std::memory_order_seq_cst) != 0) {
+                ring_doorbell();
+            }
+
+            dst += take;
+            n -= take;
+        }
+        co_return true;
+    }
+
+    // Copy `n` bytes into the outgoing ring, sleeping while it is full.
+    task<void, Error> push(const char* src, std::size_t n) {
+        while(n != 0) {
+            if(closed || output_closed) {
+                co_await fail("shared-memory transport is closed");
+            }
+
+            // Same check as pull(), for the `tail` the peer owns.
+            auto used = out_head - out->tail.load(std::memory_order_acquire);
+            if(used > capacity) {
+                close();
+                co_await fail("shared-memory ring is corrupt");
+            }
+            auto space = capacity - used;
+            if(space == 0) {
+                out->writer_waiting.store(1, std::memory_order_seq_cst);
+                used = out_head - out->tail.load(std::memory_order_seq_cst);
+                if(used > capacity) {
+                    close();
+                    co_await fail("shared-memory ring is corrupt");
+                }
+                space = capacity - used;
+                if(space == 0) {
+                    if(!co_await wait_doorbell()) {
+                        co_await fail("shared-memory peer closed");
+                    }
+                    continue;
+                }
+                out->writer_waiting.store(0, std::memory_order_relaxed);
+            }
+
+            const auto take = static_cast<std::size_t>(std::min<std::uint64_t>(space, n));
+            copy_to_ring(out_data, capacity, out_head, src, take);
+            out_head += take;
+            out->head.store(out_head, std::memory_order_seq_cst);
+            if(out->reader_waiting.exchange(0, std::memory_order_seq_cst) != 0) {
+                ring_doorbell();
+            }
+
+            src += take;
+            n -= take;
+        }
+    }
+};
+
+
+SharedMemoryTransport::SharedMemoryTransport(std::unique_ptr<Self> self) :
+    self(std::move(self)) {}
+
+SharedMemoryTransport::~SharedMemoryTransport() = default;
+
+Result<std::pair<std::unique_ptr<SharedMemoryTransport>, shared_memory_endpoint>>
+    SharedMemoryTransport::create(event_loop& loop, std::size_t ring_bytes) {
+    ring_bytes = std::bit_ceil(std::clamp(ring_bytes, min_ring_bytes, max_ring_bytes));
+    const auto size = region_size(ring_bytes);
+
+    int memory_fd = create_memory_fd();
+    if(memory_fd < 0) {
+        return outcome_error(errno_error("failed to create shared memory"));
+    }
+
+    if(::ftruncate(memory_fd, static_cast<off_t>(size)) != 0) {
+        auto err = errno_error("failed to size shared memory");
+        ::close(memory_fd);
+        return outcome_error(std::move(err));
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if(mapping == MAP_FAILED) {
+        auto err = errno_error("failed to map shared memory");
+        ::close(memory_fd);
+        return outcome_error(std::move(err));
+    }
+    auto* header = new (mapping) region_header{};
+    header->ring_bytes = ring_bytes;
+    ::munmap(mapping, size);
+
+    int doorbells[2] = {-1, -1};
+    if(::socketpair(AF_UNIX, SOCK_STREAM, 0, doorbells) != 0) {
+        auto err = errno_error("failed to create doorbell");
+        ::close(memory_fd);
+        return outcome_error(std::move(err));
+    }
+    ::fcntl(doorbells[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(doorbells[1], F_SETFD, FD_CLOEXEC);
+
+    int peer_memory_fd = ::fcntl(memory_fd, F_DUPFD_CLOEXEC, 0);
+    if(peer_memory_fd < 0) {
+        auto err = errno_error("failed to duplicate shared memory descriptor");
+        ::close(memory_fd);
+        ::close(doorbells[0]);
+        ::close(doorbells[1]);
+        return outcome_error(std::move(err));
+    }
+
+    // Opening here, before the endpoint leaves this function, makes this side the creator.
+    auto local = open(shared_memory_endpoint{memory_fd, doorbells[0]}, loop);
+    if(!local) {
+        ::close(peer_memory_fd);
+        ::close(doorbells[1]);
+        return outcome_error(local.error());
+    }
+
+    return std::pair{std::move(*local), shared_memory_endpoint{peer_memory_fd, doorbells[1]}};
+}
+
+Result<std::unique_ptr<SharedMemoryTransport>>
+    SharedMemoryTransport::open(shared_memory_endpoint endpoint, event_loop& loop) {
+    struct stat info {};
+    if(::fstat(endpoint.memory_fd, &info) != 0) {
+        auto err = errno_error("invalid shared memory descriptor");
+        ::close(endpoint.memory_fd);
+        ::close(endpoint.doorbell_fd);
+        return outcome_error(std::move(err));
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = size < data_offset ? MAP_FAILED
+                                       : ::mmap(nullptr,
+                                                size,
+                                                PROT_READ | PROT_WRITE,
+                                                MAP_SHARED,
+                                                endpoint.memory_fd,
+                                                0);
+    // The mapping keeps the memory alive; the descriptor is no longer needed.
+    ::close(endpoint.memory_fd);
+    if(mapping == MAP_FAILED) {
+        ::close(endpoint.doorbell_fd);
+        return outcome_error(Error("failed to map shared memory"));
+    }
+
+    auto self = std::make_unique<Self>();
+    self->mapping = mapping;
+    self->mapping_size = size;
+
+    auto* header = static_cast<region_header*>(mapping);
+    if(header->magic != region_magic || !std::has_single_bit(header->ring_bytes) ||
+       region_size(header->ring_bytes) != size) {
+        ::close(endpoint.doorbell_fd);
+        return outcome_error(Error("shared memory region is not an ipc link"));
+    }
+
+    const auto side = header->attached.fetch_add(1, std::memory_order_acq_rel);
+    if(side > 1) {
+        ::close(endpoint.doorbell_fd);
+        return outcome_error(Error("shared memory link already has two sides"));
+    }
+
+    auto* data = static_cast<std::byte*>(mapping) + data_offset;
+    self->capacity = static_cast<std::size_t>(header->ring_bytes);
+    self->out = &header->rings[side];
+    self->in = &header->rings[1 - side];
+    self->out_data = data + side * self->capacity;
+    self->in_data = data + (1 - side) * self->capacity;
+    self->out_head = self->out->head.load(std::memory_order_acquire);
+    self->in_tail = self->in->tail.load(std::memory_order_acquire);
+
+    auto doorbell = pipe::open(endpoint.doorbell_fd, pipe::options(), loop);
+    if(!doorbell) {
+        ::close(endpoint.doorbell_fd);
+        return outcome_error(Error(std::string(doorbell.error().message())));
+    }
+    self->doorbell = stream(std::move(*doorbell));
+    self->doorbell_fd = endpoint.doorbell_fd;
+
+    return std::unique_ptr<SharedMemoryTransport>(new SharedMemoryTransport(std::move(self)));
+}
+
+Result<std::unique_ptr<SharedMemoryTransport>>
+    SharedMemoryTransport::open_inherited(event_loop& loop) {
+    return open(shared_memory_endpoint{inherited_memory_fd, inherited_doorbell_fd}, loop);
+}
+
+Result<std::pair<process::spawn_result, std::unique_ptr<SharedMemoryTransport>>>
+    SharedMemoryTransport::spawn(process::options opts, event_loop& loop, std::size_t ring_bytes) {
+    auto link = create(loop, ring_bytes);
+    if(!link) {
+        return outcome_error(link.error());
+    }
+
+    auto& [transport, endpoint] = *link;
+    opts.extra_fds.insert(opts.extra_fds.begin(), {endpoint.memory_fd, endpoint.doorbell_fd});
+
+    auto spawned = process::spawn(opts, loop);
+    // The child has its own copies now (or never will); either way ours must go.
+    ::close(endpoint.memory_fd);
+    ::close(endpoint.doorbell_fd);
+    if(!spawned) {
+        return outcome_error(Error(std::string(spawned.error().message())));
+    }
+
+    return std::pair{std::move(*spawned), std::move(transport)};
+}
+
+task<std::optional<MessageBuffer>> SharedMemoryTransport::read_message() {
+    std::array<unsigned char, frame_header_bytes> header{};
+    if(!co_await self->pull(reinterpret_cast<char*>(header.data()), header.size())) {
+        co_return std::nullopt;
+    }
+
+    const auto length = std::size_t(header[0]) | (std::size_t(header[1]) << 8) |
+                        (std::size_t(header[2]) << 16) | (std::size_t(header[3]) << 24);
+    if(length > max_payload_bytes) {
+        co_return std::nullopt;
+    }
+
+    MessageBuffer buffer(length);
+    if(!co_await self->pull(buffer.data(), length)) {
+        co_return std::nullopt;
+    }
+    co_return std::optional<MessageBuffer>(std::move(buffer));
+}
+
+task<void, Error> SharedMemoryTransport::write_message(std::string_view payload) {
+    if(payload.size() > max_payload_bytes) {
+        co_await fail("message too large for shared-memory transport");
+    }
+
+    const auto length = static_cast<std::uint32_t>(payload.size());
+    const std::array<char, frame_header_bytes> header = {
+        static_cast<char>(length & 0xff),
+        static_cast<char>((length >> 8) & 0xff),
+        static_cast<char>((length >> 16) & 0xff),
+        static_cast<char>((length >> 24) & 0xff),
+    };
+
+    // A message streamed through a small ring spans several suspensions; keep others out.
+    co_await self->write_lock.lock();
+    auto status = co_await self->push(header.data(), header.size());
+    if(!status.has_error()) {
+        status = co_await self->push(payload.data(), payload.size());
+    }
+    self->write_lock.unlock();
+
+    if(status.has_error()) {
+        co_await fail(std::move(status).error());
+    }
+}
+
+Result<void> SharedMemoryTransport::close_output() {
+    self->close_output();
+    return {};
+}
+
+Result<void> SharedMemoryTransport::close() {
+    self->close();
+    return {};
+}
+
+#else
+
+struct SharedMemoryTransport::Self {};
+
+SharedMemoryTransport::SharedMemoryTransport(std::unique_ptr<Self> self) :
+    self(std::move(self)) {}
+
+SharedMemoryTransport::~SharedMemoryTransport() = default;
+
+namespace {
+
+Error unsupported() {
+    return Error("shared-memory transport is not supported on this platform");
+}
+
+}  // namespace
+
+Result<std::pair<std::unique_ptr<SharedMemoryTransport>, shared_memory_endpoint>>
+    SharedMemoryTransport::create(event_loop&, std::size_t) {
+    return outcome_error(unsupported());
+}
+
+Result<std::unique_ptr<SharedMemoryTransport>>
+    SharedMemoryTransport::open(shared_memory_endpoint, event_loop&) {
+    return outcome_error(unsupported());
+}
+
+Result<std::unique_ptr<SharedMemoryTransport>>
+    SharedMemoryTransport::open_inherited(event_loop&) {
+    return outcome_error(unsupported());
+}
+
+Result<std::pair<process::spawn_result, std::unique_ptr<SharedMemoryTransport>>>
+    SharedMemoryTransport::spawn(process::options, event_loop&, std::size_t) {
+    return outcome_error(unsupported());
+}
+
+task<std::optional<MessageBuffer>> SharedMemoryTransport::read_message() {
+    co_return std::nullopt;
+}
+
+task<void, Error> SharedMemoryTransport::write_message(std::string_view) {
+    co_await fail(unsupported());
+}
+
+Result<void> SharedMemoryTransport::close_output() {
+    return outcome_error(unsupported());
+}
+
+Result<void> SharedMemoryTransport::close() {
+    return outcome_error(unsupported());
+}
+
+#endif
+
+}  // namespace kota::ipc
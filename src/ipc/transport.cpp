@@ -1,13 +1,24 @@
 #include "kota/ipc/transport.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <cstring>
 #include <limits>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace kota::ipc {
 
@@ -18,6 +29,22 @@ namespace {
 constexpr std::size_t max_header_bytes = 8 * 1024;
 constexpr std::size_t max_payload_bytes = 64 * 1024 * 1024;
 
+constexpr std::string_view content_length_prefix = "Content-Length: ";
+constexpr std::size_t max_frame_header_bytes =
+    content_length_prefix.size() + std::numeric_limits<std::size_t>::digits10 + 1 + 4;
+
+// Out-of-band payloads are mapped rather than copied, so they may exceed max_payload_bytes.
+constexpr std::size_t max_attachment_bytes = std::size_t(1) << 30;
+constexpr std::string_view attachment_length_name = "Attachment-Length";
+
+std::string_view format_frame_header(std::array<char, max_frame_header_bytes>& storage,
+                                     std::size_t length) {
+    auto* out = std::ranges::copy(content_length_prefix, storage.data()).out;
+    out = std::to_chars(out, storage.data() + storage.size(), length).ptr;
+    out = std::ranges::copy(std::string_view("\r\n\r\n"), out).out;
+    return std::string_view(storage.data(), static_cast<std::size_t>(out - storage.data()));
+}
+
 std::string_view trim_ascii(std::string_view value) {
     auto start = value.find_first_not_of(" \t");
     if(start == std::string_view::npos) {
@@ -34,7 +61,41 @@ bool iequals_ascii(std::string_view lhs, std::string_view rhs) {
     });
 }
 
-std::optional<std::size_t> parse_content_length(std::string_view header) {
+struct frame_header {
+    std::size_t content_length = 0;
+    std::optional<std::size_t> attachment_length;
+};
+
+// Parse a non-negative decimal header value no larger than `limit`.
+std::optional<std::size_t> parse_size_value(std::string_view value, std::size_t limit) {
+    if(value.empty()) {
+        return std::nullopt;
+    }
+
+    std::size_t parsed = 0;
+    for(char ch: value) {
+        if(ch < '0' || ch > '9') {
+            return std::nullopt;
+        }
+        const auto digit = static_cast<std::size_t>(ch - '0');
+        if(parsed > ((std::numeric_limits<std::size_t>::max)() - digit) / 10) {
+            return std::nullopt;
+        }
+        parsed = parsed * 10 + digit;
+    }
+
+    if(parsed > limit) {
+        return std::nullopt;
+    }
+    return parsed;
+}
+
+// A frame needs a valid Content-Length. Attachment-Length marks an out-of-band payload whose
+// descriptor arrived with the frame; a malformed one rejects the frame.
+std::optional<frame_header> parse_frame_header(std::string_view header) {
+    std::optional<std::size_t> content_length;
+    std::optional<std::size_t> attachment_length;
+
     std::size_t pos = 0;
     while(pos < header.size()) {
         auto end = header.find("\r\n", pos);
@@ -51,33 +112,209 @@ std::optional<std::size_t> parse_content_length(std::string_view header) {
         }
 
         auto name = trim_ascii(line.substr(0, sep));
-        if(!iequals_ascii(name, "Content-Length")) {
-            continue;
+        if(!content_length && iequals_ascii(name, "Content-Length")) {
+            content_length = parse_size_value(trim_ascii(line.substr(sep + 1)), max_payload_bytes);
+            if(!content_length) {
+                return std::nullopt;
+            }
+        } else if(iequals_ascii(name, attachment_length_name)) {
+            attachment_length =
+                parse_size_value(trim_ascii(line.substr(sep + 1)), max_attachment_bytes);
+            if(!attachment_length) {
+                return std::nullopt;
+            }
         }
+    }
 
-        auto value = trim_ascii(line.substr(sep + 1));
-        if(value.empty()) {
-            return std::nullopt;
-        }
+    if(!content_length) {
+        return std::nullopt;
+    }
+    return frame_header{*content_length, attachment_length};
+}
 
-        std::size_t parsed = 0;
-        for(char ch: value) {
-            if(ch < '0' || ch > '9') {
-                return std::nullopt;
+// Scan `chunk` for the "\r\n\r\n" header terminator. `matched` carries how many marker
+// bytes were already seen at the end of the previous chunk, so a terminator split across
+// reads is still found. Returns the offset one past the terminator, or npos.
+std::size_t find_header_end(std::string_view chunk, std::size_t& matched) {
+    constexpr std::string_view marker = "\r\n\r\n";
+
+    std::size_t i = 0;
+    while(i < chunk.size()) {
+        if(matched == 0) {
+            i = chunk.find('\r', i);
+            if(i == std::string_view::npos) {
+                return std::string_view::npos;
             }
-            const auto digit = static_cast<std::size_t>(ch - '0');
-            if(parsed > ((std::numeric_limits<std::size_t>::max)() - digit) / 10) {
-                return std::nullopt;
+        }
+
+        const char ch = chunk[i++];
+        if(ch == marker[matched]) {
+            if(++matched == marker.size()) {
+                matched = 0;
+                return i;
             }
-            parsed = parsed * 10 + digit;
+        } else {
+            matched = ch == '\r' ? 1 : 0;
         }
+    }
+    return std::string_view::npos;
+}
 
-        if(parsed > max_payload_bytes) {
-            return std::nullopt;
+constexpr std::size_t max_attachment_header_bytes =
+    max_frame_header_bytes + attachment_length_name.size() + 2 +
+    std::numeric_limits<std::size_t>::digits10 + 1 + 2;
+
+// Reference frame for an out-of-band payload: an empty body plus the attachment's size.
+std::string_view format_attachment_header(std::array<char, max_attachment_header_bytes>& storage,
+                                          std::size_t length) {
+    auto* out = std::ranges::copy(content_length_prefix, storage.data()).out;
+    out = std::ranges::copy(std::string_view("0\r\n"), out).out;
+    out = std::ranges::copy(attachment_length_name, out).out;
+    out = std::ranges::copy(std::string_view(": "), out).out;
+    out = std::to_chars(out, storage.data() + storage.size(), length).ptr;
+    out = std::ranges::copy(std::string_view("\r\n\r\n"), out).out;
+    return std::string_view(storage.data(), static_cast<std::size_t>(out - storage.data()));
+}
+
+#if defined(__linux__)
+
+// Seals that make an attachment immutable for as long as anyone maps it, so a receiver can
+// never observe it changing or fault on a truncated page.
+constexpr int required_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+
+// Copy `payload` into a new sealed memfd, or return -1 (the caller then sends it inline).
+int create_attachment(std::string_view payload) {
+    int fd = ::memfd_create("kota-ipc-attachment", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(fd < 0) {
+        return -1;
+    }
+
+    bool ok = ::ftruncate(fd, static_cast<off_t>(payload.size())) == 0;
+    if(ok) {
+        void* mapping = ::mmap(nullptr, payload.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = mapping != MAP_FAILED;
+        if(ok) {
+            std::memcpy(mapping, payload.data(), payload.size());
+            // F_SEAL_WRITE is refused while a writable mapping exists.
+            ::munmap(mapping, payload.size());
+        }
+    }
+
+    if(!ok || ::fcntl(fd, F_ADD_SEALS, required_seals | F_SEAL_SEAL) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void release_attachment(char* data, std::size_t capacity) noexcept {
+    ::munmap(data, capacity);
+}
+
+// Map a received attachment read-only. The payload is followed by zeroed pages covering
+// MessageBuffer::padding, so codecs can parse it in place like any other buffer.
+std::optional<MessageBuffer> map_attachment(int fd, std::size_t length) {
+    const int seals = ::fcntl(fd, F_GET_SEALS);
+    if(seals < 0 || (seals & required_seals) != required_seals) {
+        return std::nullopt;
+    }
+
+    struct stat info {};
+    if(::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != length) {
+        return std::nullopt;
+    }
+
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto capacity = (length + MessageBuffer::padding + page - 1) / page * page;
+
+    // Reserve zeroed anonymous pages for payload and padding, then map the file over the
+    // front; the kernel zero-fills the file's last page past its end.
+    void* region =
+        ::mmap(nullptr, capacity, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(region == MAP_FAILED) {
+        return std::nullopt;
+    }
+    if(length != 0 &&
+       ::mmap(region, length, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        ::munmap(region, capacity);
+        return std::nullopt;
+    }
+
+    return MessageBuffer::adopt(static_cast<char*>(region), length, capacity, release_attachment);
+}
+
+#endif
+
+// Binary frames: a varint length never needs more than five bytes under max_payload_bytes.
+constexpr std::size_t max_varint_bytes = 5;
+constexpr std::size_t fixed_prefix_bytes = 4;
+constexpr std::size_t max_binary_header_bytes = max_varint_bytes + 1;
+
+std::string_view format_binary_header(std::array<char, max_binary_header_bytes>& storage,
+                                      std::size_t length,
+                                      std::uint8_t type,
+                                      const binary_framing& framing) {
+    std::size_t size = 0;
+    if(framing.prefix == binary_framing::length_prefix::fixed32) {
+        for(; size < fixed_prefix_bytes; ++size) {
+            storage[size] = static_cast<char>((length >> (8 * size)) & 0xff);
+        }
+    } else {
+        do {
+            auto byte = static_cast<std::uint8_t>(length & 0x7f);
+            length >>= 7;
+            if(length != 0) {
+                byte |= 0x80;
+            }
+            storage[size++] = static_cast<char>(byte);
+        } while(length != 0);
+    }
+
+    if(framing.type_byte) {
+        storage[size++] = static_cast<char>(type);
+    }
+    return std::string_view(storage.data(), size);
+}
+
+// Feed one length-prefix byte. `consumed` counts prefix bytes seen so far; `done` is set once
+// the prefix is complete. Returns false for a prefix that can only describe an oversized
+// payload.
+bool feed_length_byte(binary_framing::length_prefix prefix,
+                      std::uint8_t byte,
+                      std::size_t& consumed,
+                      std::size_t& length,
+                      bool& done) {
+    if(prefix == binary_framing::length_prefix::fixed32) {
+        length |= static_cast<std::size_t>(byte) << (8 * consumed);
+        done = ++consumed == fixed_prefix_bytes;
+        return true;
+    }
+
+    if(consumed == max_varint_bytes) {
+        return false;
+    }
+    length |= static_cast<std::size_t>(byte & 0x7f) << (7 * consumed);
+    ++consumed;
+    done = (byte & 0x80) == 0;
+    return true;
+}
+
+// Copy `message.size()` body bytes out of `input`. Returns false if the input ends first.
+task<bool> read_body(stream& input, MessageBuffer& message) {
+    std::size_t filled = 0;
+    while(filled < message.size()) {
+        auto chunk = co_await input.read_chunk();
+        if(!chunk) [[unlikely]] {
+            input.stop();
+            co_return false;
         }
-        return parsed;
+
+        const auto take = std::min<std::size_t>(message.size() - filled, chunk->size());
+        std::memcpy(message.data() + filled, chunk->data(), take);
+        input.consume(take);
+        filled += take;
     }
-    return std::nullopt;
+    co_return true;
 }
 
 std::string to_error_text(error err) {
@@ -125,6 +362,12 @@ Result<stream> open_stdio_stream(int fd, bool readable, event_loop& loop) {
 
 }  // namespace
 
+task<void, Error> Transport::write_messages(std::span<const std::string> payloads) {
+    for(const auto& payload: payloads) {
+        co_await write_message(payload).or_fail();
+    }
+}
+
 Result<void> Transport::close_output() {
     return outcome_error(Error("transport does not support closing output"));
 }
@@ -168,81 +411,292 @@ Result<std::unique_ptr<StreamTransport>> StreamTransport::open_tcp(int fd, event
     return std::make_unique<StreamTransport>(std::move(*channel));
 }
 
-task<std::optional<std::string>> StreamTransport::read_message() {
-    std::string header;
-    std::optional<std::size_t> content_length;
+task<std::optional<MessageBuffer>> StreamTransport::read_message() {
+    auto length = co_await read_frame_header();
+    if(!length.has_value()) {
+        co_return std::nullopt;
+    }
+
+    if(frame_attachment.has_value()) {
+        co_return take_attachment(*length);
+    }
 
-    while(!content_length.has_value()) {
+    // Copy the body straight out of the stream buffer into padded storage: this is the only
+    // copy an incoming message gets before the codec parses it.
+    MessageBuffer message(*length);
+    if(!co_await read_body(read_stream, message)) {
+        co_return std::nullopt;
+    }
+    co_return message;
+}
+
+task<std::optional<std::size_t>> StreamTransport::read_frame_header() {
+    header_spill.clear();
+    std::size_t matched = 0;
+
+    while(true) {
         auto chunk = co_await read_stream.read_chunk();
         if(!chunk) [[unlikely]] {
             read_stream.stop();
             co_return std::nullopt;
         }
 
-        const auto old_size = header.size();
-        header.append(chunk->data(), chunk->size());
-
-        auto marker = header.find("\r\n\r\n");
-        if(marker == std::string::npos) {
-            if(header.size() > max_header_bytes) [[unlikely]] {
+        auto bytes = std::string_view(chunk->data(), chunk->size());
+        auto header_end = find_header_end(bytes, matched);
+        if(header_end == std::string_view::npos) {
+            if(header_spill.size() + bytes.size() > max_header_bytes) [[unlikely]] {
                 read_stream.stop();
                 co_return std::nullopt;
             }
-            read_stream.consume(chunk->size());
+            // The header straddles a read or the ring-buffer wrap point; keep the prefix
+            // so the Content-Length line can still be parsed once the marker shows up.
+            header_spill.append(bytes);
+            read_stream.consume(bytes.size());
             continue;
         }
 
-        const auto header_end = marker + 4;
-        if(header_end > max_header_bytes) [[unlikely]] {
+        if(header_spill.size() + header_end > max_header_bytes) [[unlikely]] {
             read_stream.stop();
             co_return std::nullopt;
         }
-        const auto consumed_from_chunk = header_end > old_size ? header_end - old_size : 0;
-        read_stream.consume(consumed_from_chunk);
 
-        auto view = std::string_view(header.data(), header_end);
-        content_length = parse_content_length(view);
-        if(!content_length.has_value()) [[unlikely]] {
+        auto header = bytes.substr(0, header_end);
+        if(!header_spill.empty()) {
+            header_spill.append(header);
+            header = header_spill;
+        }
+
+        auto parsed = parse_frame_header(header);
+        read_stream.consume(header_end);
+        if(!parsed.has_value()) [[unlikely]] {
             read_stream.stop();
             co_return std::nullopt;
         }
+        frame_attachment = parsed->attachment_length;
+        co_return parsed->content_length;
     }
+}
+
+std::optional<MessageBuffer> StreamTransport::take_attachment(std::size_t content_length) {
+    // Reference frames have no body of their own; the descriptor arrived with their header.
+    std::optional<MessageBuffer> message;
+#if defined(__linux__)
+    if(content_length == 0) {
+        if(auto fd = read_stream.take_pending_fd()) {
+            message = map_attachment(*fd, *frame_attachment);
+            ::close(*fd);
+        }
+    }
+#endif
+
+    if(!message.has_value()) [[unlikely]] {
+        read_stream.stop();
+    }
+    return message;
+}
+
+task<void, Error> StreamTransport::write_message(std::string_view payload) {
+    auto& stream = shared_stream ? read_stream : write_stream;
+
+#if defined(__linux__)
+    if(attachment_threshold != 0 && payload.size() >= attachment_threshold &&
+       payload.size() <= max_attachment_bytes && stream.can_send_fds()) {
+        // Without a memfd, or on a stream that cannot carry one, the payload simply goes
+        // inline below.
+        if(int fd = create_attachment(payload); fd >= 0) {
+            std::array<char, max_attachment_header_bytes> header_storage;
+            auto header = format_attachment_header(header_storage, payload.size());
+            auto status = co_await stream.write_with_fd(header, fd);
+            ::close(fd);
+            if(status.has_error()) {
+                co_await fail(std::string(status.error().message()));
+            }
+            co_return;
+        }
+    }
+#endif
+
+    // The header goes out in front of the payload through one gather write, so the payload
+    // itself is never copied into a framed buffer.
+    std::array<char, max_frame_header_bytes> header_storage;
+    auto header = format_frame_header(header_storage, payload.size());
+
+    std::array<std::span<const char>, 2> buffers = {
+        std::span<const char>(header.data(), header.size()),
+        std::span<const char>(payload.data(), payload.size()),
+    };
+
+    auto status = co_await stream.write(std::span<const std::span<const char>>(buffers));
+    if(status.has_error()) {
+        co_await fail(std::string(status.error().message()));
+    }
+}
+
+task<void, Error> StreamTransport::write_messages(std::span<const std::string> payloads) {
+    if(payloads.empty()) {
+        co_return;
+    }
+
+    auto& stream = shared_stream ? read_stream : write_stream;
+    if(attachment_threshold != 0 && stream.can_send_fds() &&
+       std::ranges::any_of(payloads, [&](const std::string& payload) {
+           return payload.size() >= attachment_threshold;
+       })) {
+        // Each attachment needs its own write to carry its descriptor.
+        for(const auto& payload: payloads) {
+            co_await write_message(payload).or_fail();
+        }
+        co_return;
+    }
+
+    std::vector<std::array<char, max_frame_header_bytes>> headers(payloads.size());
+    std::vector<std::span<const char>> buffers;
+    buffers.reserve(payloads.size() * 2);
+
+    for(std::size_t i = 0; i < payloads.size(); ++i) {
+        auto header = format_frame_header(headers[i], payloads[i].size());
+        buffers.emplace_back(header.data(), header.size());
+        buffers.emplace_back(payloads[i].data(), payloads[i].size());
+    }
+
+    auto status = co_await stream.write(std::span<const std::span<const char>>(buffers));
+    if(status.has_error()) {
+        co_await fail(std::string(status.error().message()));
+    }
+}
 
-    std::string payload;
-    payload.reserve(*content_length);
+Result<void> StreamTransport::close_output() {
+    if(shared_stream) {
+        read_stream = stream{};
+        return {};
+    }
+
+    write_stream = stream{};
+    return {};
+}
 
-    while(payload.size() < *content_length) {
+Result<void> StreamTransport::close() {
+    read_stream.stop();
+    read_stream = stream{};
+    if(!shared_stream) {
+        write_stream = stream{};
+    }
+    return {};
+}
+
+BinaryTransport::BinaryTransport(stream input, stream output, binary_framing framing) :
+    read_stream(std::move(input)), write_stream(std::move(output)), framing(framing) {}
+
+BinaryTransport::BinaryTransport(stream stream, binary_framing framing) :
+    read_stream(std::move(stream)), shared_stream(true), framing(framing) {}
+
+task<std::optional<MessageBuffer>> BinaryTransport::read_message() {
+    auto length = co_await read_frame_header();
+    if(!length.has_value()) {
+        co_return std::nullopt;
+    }
+
+    MessageBuffer message(*length);
+    if(!co_await read_body(read_stream, message)) {
+        co_return std::nullopt;
+    }
+    co_return message;
+}
+
+task<std::optional<std::size_t>> BinaryTransport::read_frame_header() {
+    std::size_t length = 0;
+    std::size_t consumed = 0;
+    bool length_done = false;
+    last_type = 0;
+
+    while(true) {
         auto chunk = co_await read_stream.read_chunk();
         if(!chunk) [[unlikely]] {
             read_stream.stop();
             co_return std::nullopt;
         }
 
-        const auto need = *content_length - payload.size();
-        const auto take = std::min<std::size_t>(need, chunk->size());
-        payload.append(chunk->data(), take);
-        read_stream.consume(take);
+        std::size_t used = 0;
+        while(used < chunk->size()) {
+            const auto byte = static_cast<std::uint8_t>((*chunk)[used++]);
+            if(!length_done) {
+                if(!feed_length_byte(framing.prefix, byte, consumed, length, length_done))
+                    [[unlikely]] {
+                    read_stream.stop();
+                    co_return std::nullopt;
+                }
+                if(!length_done || framing.type_byte) {
+                    continue;
+                }
+            } else {
+                last_type = byte;
+            }
+
+            read_stream.consume(used);
+            if(length > max_payload_bytes) [[unlikely]] {
+                read_stream.stop();
+                co_return std::nullopt;
+            }
+            co_return length;
+        }
+        read_stream.consume(used);
+    }
+}
+
+task<void, Error> BinaryTransport::write_message(std::string_view payload, std::uint8_t type) {
+    // Larger payloads do not fit a fixed32 prefix or the varint header storage, and the
+    // reader would reject them anyway.
+    if(payload.size() > max_payload_bytes) {
+        co_await fail("message too large for binary transport");
     }
 
-    co_return payload;
+    std::array<char, max_binary_header_bytes> header_storage;
+    auto header = format_binary_header(header_storage, payload.size(), type, framing);
+
+    std::array<std::span<const char>, 2> buffers = {
+        std::span<const char>(header.data(), header.size()),
+        std::span<const char>(payload.data(), payload.size()),
+    };
+
+    auto& stream = shared_stream ? read_stream : write_stream;
+    auto status = co_await stream.write(std::span<const std::span<const char>>(buffers));
+    if(status.has_error()) {
+        co_await fail(std::string(status.error().message()));
+    }
 }
 
-task<void, Error> StreamTransport::write_message(std::string_view payload) {
-    std::string framed;
-    framed.reserve(32 + payload.size());
-    framed.append("Content-Length: ");
-    framed.append(std::to_string(payload.size()));
-    framed.append("\r\n\r\n");
-    framed.append(payload.data(), payload.size());
+task<void, Error> BinaryTransport::write_message(std::string_view payload) {
+    co_await write_message(payload, 0).or_fail();
+}
+
+task<void, Error> BinaryTransport::write_messages(std::span<const std::string> payloads) {
+    if(payloads.empty()) {
+        co_return;
+    }
+    for(const auto& payload: payloads) {
+        if(payload.size() > max_payload_bytes) {
+            co_await fail("message too large for binary transport");
+        }
+    }
+
+    std::vector<std::array<char, max_binary_header_bytes>> headers(payloads.size());
+    std::vector<std::span<const char>> buffers;
+    buffers.reserve(payloads.size() * 2);
+
+    for(std::size_t i = 0; i < payloads.size(); ++i) {
+        auto header = format_binary_header(headers[i], payloads[i].size(), 0, framing);
+        buffers.emplace_back(header.data(), header.size());
+        buffers.emplace_back(payloads[i].data(), payloads[i].size());
+    }
 
     auto& stream = shared_stream ? read_stream : write_stream;
-    auto status = co_await stream.write(std::span<const char>(framed.data(), framed.size()));
+    auto status = co_await stream.write(std::span<const std::span<const char>>(buffers));
     if(status.has_error()) {
         co_await fail(std::string(status.error().message()));
     }
 }
 
-Result<void> StreamTransport::close_output() {
+Result<void> BinaryTransport::close_output() {
     if(shared_stream) {
         read_stream = stream{};
         return {};
@@ -252,7 +706,7 @@ Result<void> StreamTransport::close_output() {
     return {};
 }
 
-Result<void> StreamTransport::close() {
+Result<void> BinaryTransport::close() {
     read_stream.stop();
     read_stream = stream{};
     if(!shared_stream) {
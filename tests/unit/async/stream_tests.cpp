@@ -2,6 +2,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "loop_fixture.h"
 #include "kota/zest/macro.h"
@@ -263,6 +264,26 @@ task<void, error>
     co_await or_fail(err);
 }
 
+task<void, error> connect_and_send_gather(std::string_view host,
+                                         int port,
+                                         std::span<const std::string_view> parts,
+                                         int& done) {
+    auto conn_res = co_await tcp::connect(host, port);
+    if(!conn_res.has_value()) {
+        bump_and_stop(done, 2);
+        co_await fail(conn_res.error());
+    }
+
+    auto conn = std::move(*conn_res);
+    std::vector<std::span<const char>> buffers;
+    for(auto part: parts) {
+        buffers.emplace_back(part.data(), part.size());
+    }
+    auto err = co_await conn.write(std::span<const std::span<const char>>(buffers));
+    bump_and_stop(done, 2);
+    co_await or_fail(err);
+}
+
 task<tcp, error> accept_once(tcp::acceptor& acc, int& done) {
     auto res = co_await acc.accept();
     bump_and_stop(done, 2);
@@ -465,6 +486,52 @@ TEST_CASE(stop, serial = true) {
     EXPECT_TRUE(task2->is_failed());
 }
 
+#ifndef _WIN32
+TEST_CASE(pass_fd) {
+    int channel[2] = {-1, -1};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, channel), 0);
+    int carried[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(carried), 0);
+
+    auto sender = pipe::open(channel[0], pipe::options(true), loop);
+    ASSERT_TRUE(sender.has_value());
+    auto receiver = pipe::open(channel[1], pipe::options(true), loop);
+    ASSERT_TRUE(receiver.has_value());
+
+    auto send = [&]() -> task<> {
+        auto sent = co_await sender->write_with_fd(std::string_view("x"), carried[1]);
+        EXPECT_TRUE(sent.has_value());
+        close_fd(carried[1]);
+    };
+
+    auto receive = [&]() -> task<int> {
+        auto chunk = co_await receiver->read_chunk();
+        EXPECT_TRUE(chunk.has_value());
+        receiver->consume(chunk->size());
+        EXPECT_EQ(receiver->pending_fds(), 1U);
+        auto fd = receiver->take_pending_fd();
+        EXPECT_EQ(receiver->pending_fds(), 0U);
+        receiver->stop();
+        co_return fd.has_value() ? *fd : -1;
+    };
+
+    auto send_task = send();
+    auto receive_task = receive();
+    schedule_all(send_task, receive_task);
+
+    // The received descriptor is the write end of `carried`.
+    const int received = receive_task.result();
+    ASSERT_TRUE(received >= 0);
+    ASSERT_EQ(write_fd(received, "ok", 2), 2);
+    close_fd(received);
+
+    char buffer[2] = {};
+    ASSERT_EQ(::read(carried[0], buffer, 2), 2);
+    EXPECT_EQ(std::string_view(buffer, 2), "ok");
+    close_fd(carried[0]);
+}
+#endif
+
 };  // TEST_SUITE(pipe)
 
 TEST_SUITE(tcp, loop_fixture) {
@@ -554,6 +621,27 @@ TEST_CASE(connect_and_write) {
     EXPECT_FALSE(client_res.has_error());
 }
 
+TEST_CASE(connect_and_gather_write) {
+    int port = pick_free_port();
+    ASSERT_TRUE(port > 0);
+
+    auto acc_res = tcp::listen("127.0.0.1", port, {}, loop);
+    ASSERT_TRUE(acc_res.has_value());
+
+    const std::array<std::string_view, 4> parts = {"kotatsu", "", "-gather", "-write"};
+
+    int done = 0;
+    auto server = accept_and_read_once(std::move(*acc_res), done);
+    auto client = connect_and_send_gather("127.0.0.1", port, parts, done);
+    schedule_all(server, client);
+
+    auto server_res = server.result();
+    auto client_res = client.result();
+    EXPECT_TRUE(server_res.has_value());
+    EXPECT_EQ(*server_res, "kotatsu-gather-write");
+    EXPECT_FALSE(client_res.has_error());
+}
+
 TEST_CASE(read_some_error) {
     int port = pick_free_port();
     ASSERT_TRUE(port > 0);
@@ -0,0 +1,124 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "loop_fixture.h"
+#include "kota/zest/zest.h"
+#include "kota/async/io/thread_pool.h"
+
+namespace kota {
+
+namespace {
+
+TEST_SUITE(thread_pool_io, loop_fixture) {
+
+TEST_CASE(runs_off_loop_thread) {
+    thread_pool pool(2);
+    EXPECT_EQ(pool.size(), 2U);
+
+    std::thread::id ran_on;
+    auto worker = [&]() -> task<> {
+        co_await pool.run([&] { ran_on = std::this_thread::get_id(); }, loop);
+    };
+
+    auto worker_task = worker();
+    schedule_all(worker_task);
+
+    EXPECT_TRUE(ran_on != std::thread::id{});
+    EXPECT_TRUE(ran_on != std::this_thread::get_id());
+}
+
+TEST_CASE(bounded_concurrency) {
+    thread_pool pool(2);
+
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    int finished = 0;
+
+    auto worker = [&]() -> task<> {
+        co_await pool.run(
+            [&] {
+                auto now = active.fetch_add(1) + 1;
+                auto seen = peak.load();
+                while(now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                active.fetch_sub(1);
+            },
+            loop);
+        finished += 1;
+    };
+
+    std::vector<task<>> workers;
+    for(int i = 0; i < 6; ++i) {
+        workers.push_back(worker());
+        loop.schedule(workers.back());
+    }
+    loop.run();
+
+    EXPECT_EQ(finished, 6);
+    EXPECT_LE(peak.load(), 2);
+}
+
+TEST_CASE(cancel_before_start) {
+    thread_pool pool(1);
+    cancellation_source source;
+    event start_target;
+    event target_submitted;
+    std::atomic<bool> blocker_started{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> target_ran{false};
+    int phase = 0;
+    int observed_phase = 0;
+    bool target_cancelled = false;
+
+    auto blocker = [&]() -> task<> {
+        co_await pool.run(
+            [&] {
+                blocker_started.store(true, std::memory_order_release);
+                while(!release.load(std::memory_order_acquire)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                }
+            },
+            loop);
+    };
+
+    // The only thread is busy, so the target is still queued when it is cancelled.
+    auto target = [&]() -> task<> {
+        co_await start_target.wait();
+        target_submitted.set();
+        auto res = co_await with_token(pool.run([&] { target_ran.store(true); }, loop),
+                                       source.token());
+        target_cancelled = res.is_cancelled();
+        observed_phase = phase;
+    };
+
+    auto canceler = [&]() -> task<> {
+        while(!blocker_started.load(std::memory_order_acquire)) {
+            co_await sleep(1, loop);
+        }
+
+        start_target.set();
+        co_await target_submitted.wait();
+
+        phase = 1;
+        source.cancel();
+        phase = 2;
+        release.store(true, std::memory_order_release);
+    };
+
+    auto blocker_task = blocker();
+    auto target_task = target();
+    auto cancel_task = canceler();
+    schedule_all(blocker_task, target_task, cancel_task);
+
+    EXPECT_TRUE(target_cancelled);
+    EXPECT_EQ(observed_phase, 1);
+    EXPECT_FALSE(target_ran.load());
+}
+
+};  // TEST_SUITE(thread_pool_io)
+
+}  // namespace
+
+}  // namespace kota
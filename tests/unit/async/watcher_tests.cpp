@@ -1,4 +1,5 @@
 #include <chrono>
+#include <vector>
 
 #include "loop_fixture.h"
 #include "kota/zest/zest.h"
@@ -25,6 +26,12 @@ task<> wait_sleep(event_loop& loop) {
     co_return;
 }
 
+task<> wait_sleep_zero(event_loop& loop, int& resumed) {
+    co_await sleep(0, loop);
+    resumed += 1;
+    co_return;
+}
+
 task<> wait_prepare(prepare& w) {
     co_await w.wait();
     event_loop::current().stop();
@@ -100,6 +107,64 @@ TEST_CASE(check_wait) {
     w.stop();
 }
 
+TEST_CASE(sleep_zero) {
+    int resumed = 0;
+    auto first = wait_sleep_zero(loop, resumed);
+    auto second = wait_sleep_zero(loop, resumed);
+    schedule_all(first, second);
+    EXPECT_EQ(resumed, 2);
+}
+
+TEST_CASE(deadline_order) {
+    // Spans more than one wheel slot at the lowest level, so some deadlines are cascaded.
+    std::vector<int> fired;
+    deadline late(loop);
+    deadline early(loop);
+    deadline middle(loop);
+    late.arm(std::chrono::milliseconds{90}, [&] { fired.push_back(90); });
+    early.arm(std::chrono::milliseconds{1}, [&] { fired.push_back(1); });
+    middle.arm(std::chrono::milliseconds{20}, [&] { fired.push_back(20); });
+    EXPECT_TRUE(late.armed());
+
+    // The wheel keeps the loop alive only while something is armed.
+    EXPECT_EQ(loop.run(), 0);
+    EXPECT_EQ(fired, (std::vector<int>{1, 20, 90}));
+    EXPECT_FALSE(late.armed());
+}
+
+TEST_CASE(deadline_cancel) {
+    int fired = 0;
+    deadline kept(loop);
+    deadline dropped(loop);
+    kept.arm(std::chrono::milliseconds{2}, [&] { fired += 1; });
+    dropped.arm(std::chrono::milliseconds{1}, [&] { fired += 100; });
+    dropped.cancel();
+    EXPECT_FALSE(dropped.armed());
+
+    {
+        deadline destroyed(loop);
+        destroyed.arm(std::chrono::milliseconds{1}, [&] { fired += 1000; });
+    }
+
+    EXPECT_EQ(loop.run(), 0);
+    EXPECT_EQ(fired, 1);
+}
+
+TEST_CASE(deadline_rearm_from_callback) {
+    int fired = 0;
+    deadline repeating(loop);
+    function<void()> tick = [&] {
+        fired += 1;
+        if(fired < 3) {
+            repeating.arm(std::chrono::milliseconds{1}, [&] { tick(); });
+        }
+    };
+    repeating.arm(std::chrono::milliseconds{1}, [&] { tick(); });
+
+    EXPECT_EQ(loop.run(), 0);
+    EXPECT_EQ(fired, 3);
+}
+
 };  // TEST_SUITE(watcher_io)
 
 }  // namespace kota
@@ -411,6 +411,31 @@ TEST_CASE(misc_behavior) {
     ASSERT_EQ(from_value, std::vector<int>({7, 9}));
 }
 
+TEST_CASE(parse_context_reuse) {
+    json::parse_context context;
+
+    person first{};
+    ASSERT_TRUE(from_json(context,
+                          R"({"id":1,"name":"alice","scores":[10,20],"active":true})",
+                          first)
+                    .has_value());
+    EXPECT_EQ(first.name, "alice");
+
+    // A failed parse must not poison the context for later documents.
+    person broken{};
+    EXPECT_FALSE(from_json(context, R"({"id":"bad"})", broken).has_value());
+
+    auto second =
+        from_json<person>(context, R"({"id":2,"name":"bob","scores":[],"active":false})");
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->id, 2);
+    EXPECT_EQ(second->name, "bob");
+    EXPECT_TRUE(second->scores.empty());
+
+    auto values = from_json<std::vector<int>>(context, R"([7,9])");
+    ASSERT_EQ(values, std::vector<int>({7, 9}));
+}
+
 };  // TEST_SUITE(serde_simdjson)
 
 struct StrictStruct {
@@ -1,6 +1,9 @@
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 #include "kota/ipc/codec/bincode.h"
 #include "kota/ipc/codec/json.h"
@@ -14,6 +17,11 @@ namespace kota::ipc {
 
 namespace {
 
+struct BorrowedAddParams {
+    std::int64_t a = 0;
+    std::int64_t b = 0;
+};
+
 template <typename T>
 bool holds(const IncomingMessage& msg) {
     return std::holds_alternative<T>(msg);
@@ -171,6 +179,80 @@ TEST_CASE(string_id_accepted) {
     EXPECT_EQ(req.method, "test/foo");
 }
 
+// 1.13 Params borrow from the message buffer and decode in place
+TEST_CASE(params_borrow_payload) {
+    JsonCodec codec;
+    auto msg = codec.parse_message(
+        R"({"jsonrpc":"2.0","id":1,"method":"test/add","params":{"a":1,"b":2}})");
+
+    ASSERT_TRUE(holds<IncomingRequest>(msg));
+    auto& req = get<IncomingRequest>(msg);
+    ASSERT_TRUE(req.payload != nullptr);
+
+    auto text = req.payload->view();
+    EXPECT_TRUE(req.params.data() >= text.data());
+    EXPECT_TRUE(req.params.data() + req.params.size() <= text.data() + text.size());
+    EXPECT_EQ(req.params, R"({"a":1,"b":2})");
+
+    auto params = codec.deserialize_params<BorrowedAddParams>(req.params);
+    ASSERT_TRUE(params.has_value());
+    EXPECT_EQ(params->a, 1);
+    EXPECT_EQ(params->b, 2);
+}
+
+// 1.14 Method names are views into the payload; escaped names are decoded
+TEST_CASE(method_borrow_payload) {
+    JsonCodec codec;
+    auto msg = codec.parse_message(R"({"jsonrpc":"2.0","method":"test/note","params":{}})");
+
+    ASSERT_TRUE(holds<IncomingNotification>(msg));
+    auto& note = get<IncomingNotification>(msg);
+    EXPECT_EQ(note.method, "test/note");
+    auto text = note.payload->view();
+    EXPECT_TRUE(note.method.data() >= text.data());
+    EXPECT_TRUE(note.method.data() + note.method.size() <= text.data() + text.size());
+
+    auto escaped = codec.parse_message(R"({"jsonrpc":"2.0","method":"\u0024/progress","id":3})");
+    ASSERT_TRUE(holds<IncomingRequest>(escaped));
+    EXPECT_EQ(get<IncomingRequest>(escaped).method, "$/progress");
+
+    auto wrong_type = codec.parse_message(R"({"jsonrpc":"2.0","method":42})");
+    ASSERT_TRUE(holds<IncomingParseError>(wrong_type));
+}
+
+// 1.15 A batch parses into its elements, in order; escaped method names each keep their own
+// storage
+TEST_CASE(batch) {
+    JsonCodec codec;
+    const std::string_view text =
+        R"( [{"jsonrpc":"2.0","id":1,"method":"a","params":{"a":1,"b":2}},)"
+        R"({"jsonrpc":"2.0","method":"b"},{"jsonrpc":"2.0","id":2,"result":3},)"
+        R"(42])";
+    EXPECT_TRUE(JsonCodec::is_batch(text));
+    EXPECT_FALSE(JsonCodec::is_batch(R"({"jsonrpc":"2.0","method":"a"})"));
+
+    std::vector<IncomingMessage> messages;
+    EXPECT_TRUE(codec.parse_batch(std::make_shared<const MessageBuffer>(text), messages));
+    ASSERT_EQ(messages.size(), 4U);
+    ASSERT_TRUE(holds<IncomingRequest>(messages[0]));
+    EXPECT_EQ(get<IncomingRequest>(messages[0]).method, "a");
+    EXPECT_EQ(get<IncomingRequest>(messages[0]).params, R"({"a":1,"b":2})");
+    ASSERT_TRUE(holds<IncomingNotification>(messages[1]));
+    EXPECT_EQ(get<IncomingNotification>(messages[1]).method, "b");
+    ASSERT_TRUE(holds<IncomingResponse>(messages[2]));
+    EXPECT_TRUE(holds<IncomingParseError>(messages[3]));
+
+    EXPECT_FALSE(codec.parse_batch(std::make_shared<const MessageBuffer>("[]"), messages));
+    ASSERT_EQ(messages.size(), 1U);
+    ASSERT_TRUE(holds<IncomingParseError>(messages[0]));
+    EXPECT_EQ(get<IncomingParseError>(messages[0]).error.code,
+              static_cast<protocol::integer>(protocol::ErrorCode::InvalidRequest));
+
+    EXPECT_FALSE(codec.parse_batch(std::make_shared<const MessageBuffer>("[{"), messages));
+    ASSERT_EQ(messages.size(), 1U);
+    EXPECT_TRUE(holds<IncomingParseError>(messages[0]));
+}
+
 };  // TEST_SUITE(ipc_json_codec_parse)
 
 // ============================================================================
@@ -339,6 +421,63 @@ TEST_CASE(empty_params_roundtrip) {
     ASSERT_TRUE(holds<IncomingRequest>(msg));
 }
 
+// 2.6 Typed encoders produce the same envelope as serialize_value + untyped encoder
+TEST_CASE(typed_encoders_match_untyped) {
+    JsonCodec codec;
+    const protocol::RequestID id{std::int64_t(7)};
+    const BorrowedAddParams params{.a = 1, .b = 2};
+
+    auto serialized = codec.serialize_value(params);
+    ASSERT_TRUE(serialized.has_value());
+
+    auto request = codec.encode_request_value(id, "math/add", params);
+    auto expected_request = codec.encode_request(id, "math/add", *serialized);
+    ASSERT_TRUE(request.has_value());
+    ASSERT_TRUE(expected_request.has_value());
+    EXPECT_EQ(*request, *expected_request);
+
+    auto note = codec.encode_notification_value("math/note", params);
+    auto expected_note = codec.encode_notification("math/note", *serialized);
+    ASSERT_TRUE(note.has_value());
+    ASSERT_TRUE(expected_note.has_value());
+    EXPECT_EQ(*note, *expected_note);
+
+    auto response = codec.encode_success_response_value(id, params);
+    auto expected_response = codec.encode_success_response(id, *serialized);
+    ASSERT_TRUE(response.has_value());
+    ASSERT_TRUE(expected_response.has_value());
+    EXPECT_EQ(*response, *expected_response);
+}
+
+// 2.7 Batch roundtrip
+TEST_CASE(batch_roundtrip) {
+    JsonCodec codec;
+    const std::vector<std::string> encoded = {
+        R"({"jsonrpc":"2.0","method":"a"})",
+        R"({"jsonrpc":"2.0","id":1,"result":null})",
+    };
+    auto batch = codec.encode_batch(encoded);
+    EXPECT_EQ(batch, R"([{"jsonrpc":"2.0","method":"a"},{"jsonrpc":"2.0","id":1,"result":null}])");
+
+    std::vector<IncomingMessage> messages;
+    EXPECT_TRUE(codec.parse_batch(std::make_shared<const MessageBuffer>(batch), messages));
+    ASSERT_EQ(messages.size(), 2U);
+    EXPECT_TRUE(holds<IncomingNotification>(messages[0]));
+    EXPECT_TRUE(holds<IncomingResponse>(messages[1]));
+}
+
+TEST_CASE(batch_encode_splices_batches) {
+    JsonCodec codec;
+    const std::vector<std::string> encoded = {
+        R"({"jsonrpc":"2.0","method":"a"})",
+        R"([{"jsonrpc":"2.0","id":1,"result":null},{"jsonrpc":"2.0","id":2,"result":3}])",
+        "[]",
+    };
+    EXPECT_EQ(codec.encode_batch(encoded),
+              R"([{"jsonrpc":"2.0","method":"a"},{"jsonrpc":"2.0","id":1,"result":null},)"
+              R"({"jsonrpc":"2.0","id":2,"result":3}])");
+}
+
 };  // TEST_SUITE(ipc_json_codec_roundtrip)
 
 TEST_SUITE(ipc_bincode_codec_roundtrip) {
@@ -1,4 +1,6 @@
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "kota/zest/zest.h"
 #include "kota/ipc/lsp/position.h"
@@ -235,6 +237,126 @@ TEST_CASE(strict_utf8_validation) {
     expect_invalid_sequence('a', 0xF0u, 0x9Fu, 'b');
 }
 
+TEST_CASE(long_lines_block_scan) {
+    // Lines much longer than a SIMD block, mixing ASCII lines with lines whose multi-byte and
+    // malformed sequences straddle block boundaries.
+    struct Piece {
+        std::string_view bytes;
+        std::uint32_t utf16;
+        std::uint32_t utf32;
+    };
+
+    constexpr Piece pieces[] = {
+        {"abc", 3, 3},
+        {"\xc3\xa9", 1, 1},
+        {"\xe4\xbd\xa0", 1, 1},
+        {"\xf0\x9f\x99\x82", 2, 1},
+        {"\xc0\x80", 2, 2},
+        {"\xf0\x9f", 2, 2},
+        {"\xed\xa0\x80", 3, 3},
+    };
+
+    struct Sample {
+        std::uint32_t offset;
+        std::uint32_t line;
+        std::uint32_t utf16_character;
+        std::uint32_t utf32_character;
+    };
+
+    std::string content;
+    std::vector<Sample> samples;
+    std::uint32_t line = 0;
+    std::uint32_t utf16 = 0;
+    std::uint32_t utf32 = 0;
+    for(std::uint32_t i = 0; i < 600; ++i) {
+        // Every fourth line is plain ASCII.
+        const auto& piece = (line % 4 == 3) ? pieces[0] : pieces[(i * 5 + line) % 7];
+        content.append(piece.bytes);
+        utf16 += piece.utf16;
+        utf32 += piece.utf32;
+        samples.push_back({static_cast<std::uint32_t>(content.size()), line, utf16, utf32});
+
+        if(i % 97 == 96) {
+            content.push_back('\n');
+            line += 1;
+            utf16 = 0;
+            utf32 = 0;
+        }
+    }
+
+    PositionMapper utf16_converter(content, PositionEncoding::UTF16);
+    PositionMapper utf32_converter(content, PositionEncoding::UTF32);
+    for(const auto& sample: samples) {
+        auto utf16_position = utf16_converter.to_position(sample.offset);
+        ASSERT_TRUE(utf16_position.has_value());
+        EXPECT_EQ(utf16_position->line, sample.line);
+        EXPECT_EQ(utf16_position->character, sample.utf16_character);
+        EXPECT_EQ(utf16_converter.to_offset(*utf16_position), sample.offset);
+
+        auto utf32_position = utf32_converter.to_position(sample.offset);
+        ASSERT_TRUE(utf32_position.has_value());
+        EXPECT_EQ(utf32_position->character, sample.utf32_character);
+        EXPECT_EQ(utf32_converter.to_offset(*utf32_position), sample.offset);
+    }
+
+    // Past the end of an ASCII line and of a mixed one.
+    EXPECT_FALSE(utf16_converter.to_offset({.line = 3, .character = 292}).has_value());
+    EXPECT_TRUE(utf16_converter.to_offset({.line = 3, .character = 291}).has_value());
+    EXPECT_FALSE(utf16_converter.to_offset({.line = 0, .character = 100000}).has_value());
+}
+
+TEST_CASE(batch_conversions) {
+    // "x😂y\n" then "é😂" then "z": offsets inside the emoji and a trailing out-of-range one.
+    std::string_view content = "x\xf0\x9f\x98\x82y\n\xc3\xa9\xf0\x9f\x98\x82\nz";
+
+    for(auto encoding: {PositionEncoding::UTF8, PositionEncoding::UTF16, PositionEncoding::UTF32}) {
+        PositionMapper converter(content, encoding);
+
+        // Ascending, then going back to an earlier line, then past the end.
+        constexpr std::uint32_t offsets[] = {0, 1, 3, 5, 6, 7, 9, 11, 13, 14, 15, 2, 8, 16, 99};
+        auto positions = converter.to_positions(offsets);
+        ASSERT_EQ(positions.size(), std::size(offsets));
+        for(std::size_t i = 0; i < std::size(offsets); ++i) {
+            auto expected = converter.to_position(offsets[i]);
+            ASSERT_EQ(positions[i].has_value(), expected.has_value());
+            if(expected) {
+                EXPECT_EQ(positions[i]->line, expected->line);
+                EXPECT_EQ(positions[i]->character, expected->character);
+            }
+        }
+
+        std::vector<protocol::Position> queries;
+        for(std::uint32_t line = 0; line < 4; ++line) {
+            for(std::uint32_t character = 0; character < 8; ++character) {
+                queries.push_back({.line = line, .character = character});
+            }
+        }
+        queries.push_back({.line = 0, .character = 2});
+        queries.push_back({.line = 1, .character = 0});
+
+        auto offsets_back = converter.to_offsets(queries);
+        ASSERT_EQ(offsets_back.size(), queries.size());
+        for(std::size_t i = 0; i < queries.size(); ++i) {
+            EXPECT_EQ(offsets_back[i], converter.to_offset(queries[i]));
+        }
+    }
+
+    PositionMapper utf16_converter(content, PositionEncoding::UTF16);
+    constexpr std::uint32_t emoji_offsets[] = {1, 3, 5, 13};
+    auto positions = utf16_converter.to_positions(emoji_offsets);
+    EXPECT_EQ(positions[0]->character, 1U);
+    EXPECT_EQ(positions[1]->character, 3U);
+    EXPECT_EQ(positions[2]->character, 3U);
+    EXPECT_EQ(positions[3]->line, 1U);
+    EXPECT_EQ(positions[3]->character, 3U);
+
+    std::vector<protocol::Position> inside_pair = {{.line = 0, .character = 2},
+                                                   {.line = 0, .character = 3}};
+    auto offsets_back = utf16_converter.to_offsets(inside_pair);
+    EXPECT_FALSE(offsets_back[0].has_value());
+    EXPECT_EQ(offsets_back[1], 5U);
+}
+
 TEST_CASE(to_position_out_of_range) {
     std::string_view content = "abc\ndef";
     PositionMapper converter(content, PositionEncoding::UTF8);
@@ -1,3 +1,4 @@
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -10,6 +11,7 @@
 namespace kota::ipc {
 namespace {
 
+using lsp::PartialResultWriter;
 using lsp::ProgressReporter;
 
 TEST_SUITE(ipc_progress) {
@@ -157,6 +159,112 @@ TEST_CASE(create_failure) {
     EXPECT_EQ(create_result.error().message, "not supported");
 }
 
+TEST_CASE(partial_results_chunked) {
+    auto transport = std::make_unique<ScriptedTransport>(std::vector<std::string>{},
+                                                         ScriptedTransport::WriteHook{});
+    auto* tp = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<int> final_result = {-1};
+
+    auto producer = [&]() -> task<> {
+        PartialResultWriter<JsonPeer, int> writer(peer, protocol::ProgressToken(7), 2);
+        EXPECT_TRUE(writer.streaming());
+        for(int i = 0; i < 5; ++i) {
+            auto pushed = co_await writer.push(i);
+            EXPECT_TRUE(pushed.has_value());
+        }
+        auto finished = co_await writer.finish();
+        EXPECT_TRUE(finished.has_value());
+        if(finished) {
+            final_result = std::move(*finished);
+        }
+        tp->close();
+    };
+
+    auto producer_task = producer();
+    loop.schedule(peer.run());
+    loop.schedule(producer_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_TRUE(final_result.empty());
+    ASSERT_EQ(tp->outgoing().size(), 3U);
+    EXPECT_TRUE(tp->outgoing()[0].find(R"("method":"$/progress")") != std::string::npos);
+    EXPECT_TRUE(tp->outgoing()[0].find(R"("token":7)") != std::string::npos);
+    EXPECT_TRUE(tp->outgoing()[0].find(R"("value":[0,1])") != std::string::npos);
+    EXPECT_TRUE(tp->outgoing()[1].find(R"("value":[2,3])") != std::string::npos);
+    EXPECT_TRUE(tp->outgoing()[2].find(R"("value":[4])") != std::string::npos);
+}
+
+TEST_CASE(partial_results_without_token) {
+    auto transport = std::make_unique<ScriptedTransport>(std::vector<std::string>{},
+                                                         ScriptedTransport::WriteHook{});
+    auto* tp = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<int> final_result;
+
+    auto producer = [&]() -> task<> {
+        PartialResultWriter<JsonPeer, int> writer(peer, std::nullopt, 2);
+        EXPECT_FALSE(writer.streaming());
+        for(int i = 0; i < 5; ++i) {
+            co_await writer.push(i);
+        }
+        auto finished = co_await writer.finish();
+        if(finished) {
+            final_result = std::move(*finished);
+        }
+        tp->close();
+    };
+
+    auto producer_task = producer();
+    loop.schedule(peer.run());
+    loop.schedule(producer_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_EQ(final_result, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_TRUE(tp->outgoing().empty());
+}
+
+TEST_CASE(partial_results_wrapped_value) {
+    auto transport = std::make_unique<ScriptedTransport>(std::vector<std::string>{},
+                                                         ScriptedTransport::WriteHook{});
+    auto* tp = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::optional<protocol::SemanticTokensPartialResult> final_result;
+
+    auto producer = [&]() -> task<> {
+        PartialResultWriter<JsonPeer, protocol::uinteger, protocol::SemanticTokensPartialResult>
+            writer(peer, protocol::ProgressToken(3), 5);
+        for(protocol::uinteger i = 0; i < 10; ++i) {
+            co_await writer.push(i);
+        }
+        auto finished = co_await writer.finish();
+        if(finished) {
+            final_result = std::move(*finished);
+        }
+        tp->close();
+    };
+
+    auto producer_task = producer();
+    loop.schedule(peer.run());
+    loop.schedule(producer_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_TRUE(final_result.has_value());
+    EXPECT_TRUE(final_result->data.empty());
+    ASSERT_EQ(tp->outgoing().size(), 2U);
+    EXPECT_TRUE(tp->outgoing()[0].find(R"("value":{"data":[0,1,2,3,4]})") != std::string::npos);
+    EXPECT_TRUE(tp->outgoing()[1].find(R"("value":{"data":[5,6,7,8,9]})") != std::string::npos);
+}
+
 };  // TEST_SUITE(ipc_progress)
 
 }  // namespace
@@ -0,0 +1,111 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kota/zest/zest.h"
+#include "kota/ipc/lsp/position.h"
+#include "kota/ipc/lsp/text_document.h"
+
+namespace kota::ipc::lsp {
+namespace {
+
+protocol::TextDocumentContentChangeEvent change(protocol::Position start,
+                                                protocol::Position end,
+                                                std::string text) {
+    return protocol::TextDocumentContentChangePartial{
+        .range = {.start = start, .end = end},
+        .text = std::move(text),
+    };
+}
+
+TEST_SUITE(language_text_document) {
+
+TEST_CASE(matches_position_mapper) {
+    std::string_view content = "a\xe4\xbd\xa0\xf0\x9f\x99\x82" "b\nx\n\nlast";
+
+    for(auto encoding: {PositionEncoding::UTF8, PositionEncoding::UTF16, PositionEncoding::UTF32}) {
+        PositionMapper mapper(content, encoding);
+        TextDocument document(content, encoding);
+        ASSERT_EQ(document.size(), content.size());
+        ASSERT_EQ(document.line_count(), 4U);
+
+        constexpr std::uint32_t offsets[] = {0, 1, 4, 8, 9, 10, 11, 12, 13, 17};
+        for(auto offset: offsets) {
+            auto expected = mapper.to_position(offset);
+            auto position = document.to_position(offset);
+            ASSERT_TRUE(position.has_value());
+            EXPECT_EQ(position->line, expected->line);
+            EXPECT_EQ(position->character, expected->character);
+            EXPECT_EQ(document.to_offset(*position), mapper.to_offset(*expected));
+        }
+        EXPECT_FALSE(document.to_position(18).has_value());
+        EXPECT_FALSE(document.to_offset({.line = 4, .character = 0}).has_value());
+    }
+}
+
+TEST_CASE(incremental_changes) {
+    TextDocument document("int main() {\n    return 0;\n}\n", PositionEncoding::UTF16);
+
+    std::vector<protocol::TextDocumentContentChangeEvent> changes;
+    changes.push_back(change({1, 11}, {1, 12}, "1"));
+    changes.push_back(change({1, 0}, {1, 0}, "    int x = 0;\n"));
+    changes.push_back(change({0, 4}, {0, 8}, "start"));
+    ASSERT_TRUE(document.apply(changes));
+
+    EXPECT_EQ(document.text(), "int start() {\n    int x = 0;\n    return 1;\n}\n");
+    EXPECT_EQ(document.line_count(), 5U);
+    EXPECT_EQ(document.line_start(2), 29U);
+    EXPECT_EQ(document.text(document.line_start(2), document.line_end_exclusive(2)),
+              "    return 1;");
+
+    ASSERT_TRUE(document.apply(protocol::TextDocumentContentChangeWholeDocument{.text = "x"}));
+    EXPECT_EQ(document.text(), "x");
+    EXPECT_EQ(document.line_count(), 1U);
+}
+
+TEST_CASE(clamps_and_rejects_ranges) {
+    TextDocument document("ab\n\xf0\x9f\x99\x82", PositionEncoding::UTF16);
+
+    // Past the line end means the line end; past the last line means the document end.
+    ASSERT_TRUE(document.apply(change({0, 1}, {0, 99}, "c")));
+    ASSERT_TRUE(document.apply(change({7, 0}, {9, 9}, "!")));
+    EXPECT_EQ(document.text(), "ac\n\xf0\x9f\x99\x82!");
+
+    // Inside a surrogate pair, and a reversed range.
+    EXPECT_FALSE(document.apply(change({1, 1}, {1, 2}, "x")));
+    EXPECT_FALSE(document.apply(change({1, 0}, {0, 0}, "x")));
+    EXPECT_EQ(document.text(), "ac\n\xf0\x9f\x99\x82!");
+}
+
+TEST_CASE(large_document_edits) {
+    // Spans many chunks, so lines and edits cross chunk boundaries.
+    std::string expected;
+    for(int i = 0; i < 2000; ++i) {
+        expected += "line " + std::to_string(i) + "\n";
+    }
+    TextDocument document(expected, PositionEncoding::UTF16);
+
+    for(std::uint32_t line = 0; line < 2000; line += 97) {
+        auto start = document.line_start(line);
+        document.replace(start, start, "// ");
+        expected.insert(start, "// ");
+    }
+    auto middle = document.line_start(1000);
+    auto tail = document.line_start(1500);
+    document.replace(middle, tail, "gone\n");
+    expected.replace(middle, tail - middle, "gone\n");
+
+    ASSERT_EQ(document.text(), expected);
+    EXPECT_EQ(document.line_count(), 1502U);
+    PositionMapper mapper(expected, PositionEncoding::UTF16);
+    for(std::uint32_t line = 0; line < document.line_count(); line += 37) {
+        EXPECT_EQ(document.line_start(line), mapper.line_start(line));
+        EXPECT_EQ(document.line_end_exclusive(line), mapper.line_end_exclusive(line));
+    }
+    EXPECT_EQ(document.line_of(middle), 1000U);
+}
+
+};  // TEST_SUITE(language_text_document)
+
+}  // namespace
+}  // namespace kota::ipc::lsp
@@ -1,3 +1,7 @@
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "kota/zest/zest.h"
 #include "kota/ipc/lsp/uri.h"
 
@@ -156,6 +160,69 @@ TEST_CASE(non_file_path_fails) {
     EXPECT_FALSE(uri->file_path().has_value());
 }
 
+TEST_CASE(interner_reuses_entries) {
+    URIInterner interner;
+
+    auto first = interner.intern("file:///tmp/a%20b.cpp");
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ((*first)->text, "file:///tmp/a%20b.cpp");
+    EXPECT_EQ((*first)->uri.path(), "/tmp/a%20b.cpp");
+    ASSERT_TRUE((*first)->file_path.has_value());
+    EXPECT_EQ(*(*first)->file_path, "/tmp/a b.cpp");
+
+    auto again = interner.intern("file:///tmp/a%20b.cpp");
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(*again, *first);
+
+    // The path direction finds the entry interned from the client's text.
+    auto by_path = interner.intern_file_path("/tmp/a b.cpp");
+    ASSERT_TRUE(by_path.has_value());
+    EXPECT_EQ(*by_path, *first);
+    EXPECT_EQ(interner.size(), 1U);
+
+    auto remote = interner.intern("https://example.com/a.txt");
+    ASSERT_TRUE(remote.has_value());
+    EXPECT_FALSE((*remote)->file_path.has_value());
+
+    EXPECT_FALSE(interner.intern("noscheme").has_value());
+    EXPECT_FALSE(interner.intern_file_path("relative/path").has_value());
+    EXPECT_EQ(interner.size(), 2U);
+}
+
+TEST_CASE(interner_concurrent_intern) {
+    URIInterner interner;
+
+    std::vector<std::string> texts;
+    for(int index = 0; index < 64; ++index) {
+        texts.push_back("file:///src/file" + std::to_string(index) + ".cpp");
+    }
+
+    std::vector<std::vector<const InternedURI*>> seen(4);
+    std::vector<std::thread> workers;
+    for(auto& entries: seen) {
+        workers.emplace_back([&] {
+            for(int round = 0; round < 50; ++round) {
+                for(const auto& text: texts) {
+                    auto entry = interner.intern(text);
+                    entries.push_back(entry ? *entry : nullptr);
+                }
+            }
+        });
+    }
+    for(auto& worker: workers) {
+        worker.join();
+    }
+
+    EXPECT_EQ(interner.size(), texts.size());
+    for(const auto& entries: seen) {
+        ASSERT_EQ(entries.size(), seen[0].size());
+        for(std::size_t index = 0; index < entries.size(); ++index) {
+            EXPECT_TRUE(entries[index] != nullptr);
+            EXPECT_EQ(entries[index], seen[0][index]);
+        }
+    }
+}
+
 };  // TEST_SUITE(language_uri)
 
 }  // namespace
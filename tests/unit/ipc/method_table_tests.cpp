@@ -0,0 +1,73 @@
+#include <string>
+#include <string_view>
+
+#include "kota/ipc/method_table.h"
+#include "kota/zest/zest.h"
+
+namespace kota::ipc {
+
+namespace {
+
+TEST_SUITE(ipc_method_table) {
+
+TEST_CASE(find_registered) {
+    detail::method_table<int> table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_TRUE(table.find("initialize") == nullptr);
+
+    table.insert_or_assign("initialize", 1);
+    table.insert_or_assign("textDocument/didOpen", 2);
+
+    ASSERT_TRUE(table.find("initialize") != nullptr);
+    EXPECT_EQ(*table.find("initialize"), 1);
+    ASSERT_TRUE(table.find("textDocument/didOpen") != nullptr);
+    EXPECT_EQ(*table.find("textDocument/didOpen"), 2);
+    EXPECT_TRUE(table.find("textDocument/didClose") == nullptr);
+    EXPECT_TRUE(table.find("") == nullptr);
+}
+
+TEST_CASE(assign_replaces) {
+    detail::method_table<std::string> table;
+    table.insert_or_assign("shutdown", "first");
+    table.insert_or_assign("shutdown", "second");
+
+    EXPECT_EQ(table.size(), 1U);
+    ASSERT_TRUE(table.find("shutdown") != nullptr);
+    EXPECT_EQ(*table.find("shutdown"), "second");
+}
+
+TEST_CASE(grows_past_initial_slots) {
+    detail::method_table<int> table;
+    for(int i = 0; i < 200; ++i) {
+        table.insert_or_assign("method/" + std::to_string(i), i);
+    }
+
+    EXPECT_EQ(table.size(), 200U);
+    for(int i = 0; i < 200; ++i) {
+        auto name = "method/" + std::to_string(i);
+        auto* value = table.find(std::string_view(name));
+        ASSERT_TRUE(value != nullptr);
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_TRUE(table.find("method/200") == nullptr);
+}
+
+TEST_CASE(found_value_survives_growth) {
+    detail::method_table<std::string> table;
+    table.insert_or_assign("initialize", "kept");
+    auto* value = table.find("initialize");
+    ASSERT_TRUE(value != nullptr);
+
+    for(int i = 0; i < 200; ++i) {
+        table.insert_or_assign("method/" + std::to_string(i), std::to_string(i));
+    }
+
+    EXPECT_TRUE(table.find("initialize") == value);
+    EXPECT_EQ(*value, "kept");
+}
+
+};  // TEST_SUITE(ipc_method_table)
+
+}  // namespace
+
+}  // namespace kota::ipc
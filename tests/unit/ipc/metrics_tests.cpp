@@ -0,0 +1,68 @@
+#include <chrono>
+
+#include "kota/ipc/metrics.h"
+#include "kota/zest/zest.h"
+
+namespace kota::ipc {
+
+namespace {
+
+using std::chrono::nanoseconds;
+
+TEST_SUITE(ipc_metrics) {
+
+TEST_CASE(empty_histogram) {
+    latency_histogram histogram;
+    EXPECT_EQ(histogram.count(), 0U);
+    EXPECT_EQ(histogram.percentile(0.5).count(), 0);
+}
+
+TEST_CASE(small_values_exact) {
+    latency_histogram histogram;
+    histogram.record(nanoseconds(1));
+    histogram.record(nanoseconds(2));
+    histogram.record(nanoseconds(3));
+
+    EXPECT_EQ(histogram.count(), 3U);
+    EXPECT_EQ(histogram.percentile(0.5).count(), 2);
+    EXPECT_EQ(histogram.percentile(1.0).count(), 3);
+}
+
+TEST_CASE(percentile_within_bucket_error) {
+    latency_histogram histogram;
+    for(int i = 0; i < 99; ++i) {
+        histogram.record(std::chrono::microseconds(10));
+    }
+    histogram.record(std::chrono::milliseconds(5));
+
+    // Reported values are bucket upper bounds, at most 25% above the recorded value.
+    const auto p50 = histogram.percentile(0.5).count();
+    EXPECT_GE(p50, 10'000);
+    EXPECT_LE(p50, 12'500);
+
+    const auto p99 = histogram.percentile(0.99).count();
+    EXPECT_GE(p99, 10'000);
+    EXPECT_LE(p99, 12'500);
+
+    const auto max = histogram.percentile(1.0).count();
+    EXPECT_GE(max, 5'000'000);
+    EXPECT_LE(max, 6'250'000);
+}
+
+TEST_CASE(negative_and_merge) {
+    latency_histogram first;
+    first.record(nanoseconds(-5));
+    latency_histogram second;
+    second.record(nanoseconds(1000));
+
+    first.merge(second);
+    EXPECT_EQ(first.count(), 2U);
+    EXPECT_EQ(first.percentile(0.5).count(), 0);
+    EXPECT_GE(first.percentile(1.0).count(), 1000);
+}
+
+};  // TEST_SUITE(ipc_metrics)
+
+}  // namespace
+
+}  // namespace kota::ipc
@@ -135,6 +135,35 @@ TEST_CASE(mixed_sequence) {
     EXPECT_EQ(response->result->sum, 30);
 }
 
+// A handler that registers more handlers, as dynamic registration does, keeps running.
+TEST_CASE(register_from_notification) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"first"}})",
+        R"({"jsonrpc":"2.0","method":"test/extra7","params":{"text":"second"}})",
+    });
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    std::vector<std::string> seen;
+
+    peer.on_notification([&](const NoteParams& params) {
+        // Enough registrations to regrow the table while this handler is on the stack.
+        for(int i = 0; i < 64; ++i) {
+            peer.on_notification("test/extra" + std::to_string(i), [&](const NoteParams& extra) {
+                seen.push_back("extra:" + extra.text);
+            });
+        }
+        seen.push_back("note:" + params.text);
+    });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(seen.size(), 2U);
+    EXPECT_EQ(seen[0], "note:first");
+    EXPECT_EQ(seen[1], "extra:second");
+}
+
 };  // TEST_SUITE(ipc_peer_dispatch)
 
 }  // namespace
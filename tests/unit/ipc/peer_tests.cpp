@@ -1,6 +1,8 @@
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -943,11 +945,11 @@ TEST_CASE(zero_timeout_cancel) {
     EXPECT_TRUE(transport_ptr->outgoing().empty());
 }
 
-// Verify that completing a request before its timeout doesn't leak the timer coroutine frame.
-// Before the fix, cancel_after_timeout held a shared_ptr<cancellation_source> in its coroutine
-// frame that was only released when the timer fired. If the request completed early and the peer
-// was closed, the timer task's coroutine frame (and its captured shared_ptrs) leaked.
-// ASan will catch this as a leak if the fix regresses.
+// Verify that completing a request before its timeout disarms the timeout and leaks nothing.
+// An earlier version ran the timeout as a separate coroutine holding a shared_ptr to the
+// cancellation source, and that frame leaked if the request completed early and the peer was
+// closed. The timeout deadline must also not keep the loop running once the request is done.
+// ASan will catch a leak if this regresses.
 TEST_CASE(timeout_timer_cleanup_on_early_completion) {
     auto transport = std::make_unique<ScriptedTransport>(
         std::vector<std::string>{},
@@ -1007,6 +1009,649 @@ TEST_CASE(raw_value_return) {
     EXPECT_EQ(response->result->sum, 30);
 }
 
+TEST_CASE(write_coalescing_batches_queued) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<std::size_t> flushes;
+    peer.set_write_coalescing(write_coalescing_options{
+        .max_messages = 3,
+        .on_flush = [&](std::size_t messages, std::size_t) { flushes.push_back(messages); },
+    });
+
+    // Everything is queued before the write loop starts, so flushes are bounded only by the
+    // message limit.
+    for(int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(peer.send_notification(NoteParams{.text = std::to_string(i)}).has_value());
+    }
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(flushes.size(), 2U);
+    EXPECT_EQ(flushes[0], 3U);
+    EXPECT_EQ(flushes[1], 2U);
+
+    ASSERT_EQ(transport_ptr->outgoing().size(), 5U);
+    for(std::size_t i = 0; i < 5; ++i) {
+        auto note = codec::json::from_json<Notification>(transport_ptr->outgoing()[i]);
+        ASSERT_TRUE(note.has_value());
+        EXPECT_EQ(note->params.text, std::to_string(i));
+    }
+}
+
+TEST_CASE(write_coalescing_byte_limit) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<std::size_t> flushes;
+    peer.set_write_coalescing(write_coalescing_options{
+        .max_bytes = 1,
+        .on_flush = [&](std::size_t messages, std::size_t) { flushes.push_back(messages); },
+    });
+
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "a"}).has_value());
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "b"}).has_value());
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    // Each message exceeds the byte budget on its own but is still sent.
+    ASSERT_EQ(flushes.size(), 2U);
+    EXPECT_EQ(flushes[0], 1U);
+    EXPECT_EQ(flushes[1], 1U);
+    EXPECT_EQ(transport_ptr->outgoing().size(), 2U);
+}
+
+TEST_CASE(batch_incoming_dispatched_in_order) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"([{"jsonrpc":"2.0","id":1,"method":"test/add","params":{"a":1,"b":2}},)"
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"hi"}}])",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    std::vector<std::string> order;
+
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        order.emplace_back("request");
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.on_notification([&](const NoteParams& params) { order.push_back(params.text); });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(order.size(), 2U);
+    EXPECT_EQ(order[0], "request");
+    EXPECT_EQ(order[1], "hi");
+
+    // A batch is answered with a batch, even when it holds a single request.
+    ASSERT_EQ(transport_ptr->outgoing().size(), 1U);
+    auto responses =
+        codec::json::from_json<std::vector<Response>>(transport_ptr->outgoing().front());
+    ASSERT_TRUE(responses.has_value());
+    ASSERT_EQ(responses->size(), 1U);
+    ASSERT_TRUE((*responses)[0].result.has_value());
+    EXPECT_EQ((*responses)[0].result->sum, 3);
+}
+
+TEST_CASE(batch_replies_in_one_frame) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"([{"jsonrpc":"2.0","id":1,"method":"test/add","params":{"a":1,"b":2}},)"
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"hi"}},)"
+        R"({"jsonrpc":"2.0","id":2,"method":"test/missing","params":{}},)"
+        R"({"jsonrpc":"2.0","id":3,"method":"test/add","params":{"a":3,"b":4}}])",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"after"}})",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        // Finish out of order, so the batch has to wait for the slower request.
+        co_await sleep(params.a == 1 ? 2 : 0, loop);
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.on_notification([&](const NoteParams&) {});
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(transport_ptr->outgoing().size(), 1U);
+    const auto& frame = transport_ptr->outgoing().front();
+    EXPECT_TRUE(JsonCodec::is_batch(frame));
+
+    // Replies are in completion order; the notification gets none.
+    auto responses = codec::json::from_json<std::vector<protocol::Value>>(frame);
+    ASSERT_TRUE(responses.has_value());
+    ASSERT_EQ(responses->size(), 3U);
+    EXPECT_NE(frame.find(R"("id":1,"result":{"sum":3})"), std::string::npos);
+    EXPECT_NE(frame.find(R"("id":3,"result":{"sum":7})"), std::string::npos);
+    EXPECT_NE(frame.find(R"("id":2,"error")"), std::string::npos);
+}
+
+TEST_CASE(batch_of_notifications_gets_no_reply) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"([{"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}},)"
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"b"}}])",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    std::vector<std::string> seen;
+    peer.on_notification([&](const NoteParams& params) { seen.push_back(params.text); });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_EQ(seen, (std::vector<std::string>{"a", "b"}));
+    EXPECT_TRUE(transport_ptr->outgoing().empty());
+}
+
+TEST_CASE(write_coalescing_batch_frames) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    peer.set_write_coalescing(write_coalescing_options{.max_messages = 2, .batch_frames = true});
+
+    for(int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(peer.send_notification(NoteParams{.text = std::to_string(i)}).has_value());
+    }
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    // A flush of two goes out as one batch frame, the remaining single message as itself.
+    ASSERT_EQ(transport_ptr->outgoing().size(), 2U);
+    auto batch = codec::json::from_json<std::vector<Notification>>(transport_ptr->outgoing()[0]);
+    ASSERT_TRUE(batch.has_value());
+    ASSERT_EQ(batch->size(), 2U);
+    EXPECT_EQ((*batch)[0].params.text, "0");
+    EXPECT_EQ((*batch)[1].params.text, "1");
+
+    auto last = codec::json::from_json<Notification>(transport_ptr->outgoing()[1]);
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->params.text, "2");
+}
+
+TEST_CASE(worker_request_off_loop) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","id":41,"method":"test/add","params":{"a":20,"b":22}})",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    const auto loop_thread = std::this_thread::get_id();
+    std::thread::id handler_thread;
+    peer.on_worker_request(
+        [&](const AddParams& params, const cancellation_token&) -> Result<AddResult> {
+            handler_thread = std::this_thread::get_id();
+            return AddResult{.sum = params.a + params.b};
+        });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_TRUE(handler_thread != std::thread::id{});
+    EXPECT_TRUE(handler_thread != loop_thread);
+
+    ASSERT_EQ(transport_ptr->outgoing().size(), 1U);
+    auto response = codec::json::from_json<Response>(transport_ptr->outgoing().front());
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(std::get<std::int64_t>(response->id), 41);
+    ASSERT_TRUE(response->result.has_value());
+    EXPECT_EQ(response->result->sum, 42);
+}
+
+TEST_CASE(worker_request_cancel) {
+    auto transport = std::make_unique<ScriptedTransport>(
+        std::vector<std::string>{
+            R"({"jsonrpc":"2.0","id":42,"method":"test/add","params":{"a":1,"b":2}})",
+        },
+        nullptr);
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::atomic<bool> started = false;
+    std::atomic<bool> observed_cancel = false;
+    peer.on_worker_request(
+        [&](const AddParams& params, const cancellation_token& token) -> Result<AddResult> {
+            started = true;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while(!token.cancelled() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            observed_cancel = token.cancelled();
+            return AddResult{.sum = params.a + params.b};
+        });
+
+    auto canceler = [&]() -> task<> {
+        while(!started) {
+            co_await sleep(1, loop);
+        }
+        transport_ptr->push_incoming(
+            R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":42}})");
+        co_await sleep(5, loop);
+        transport_ptr->close();
+    };
+
+    auto cancel_task = canceler();
+    loop.schedule(peer.run());
+    loop.schedule(cancel_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_TRUE(observed_cancel.load());
+
+    ASSERT_EQ(transport_ptr->outgoing().size(), 1U);
+    auto response = codec::json::from_json<ErrorResponse>(transport_ptr->outgoing().front());
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(std::get<std::int64_t>(response->id), 42);
+    EXPECT_EQ(response->error.code,
+              static_cast<protocol::integer>(protocol::ErrorCode::RequestCancelled));
+}
+
+TEST_CASE(worker_request_own_pool) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","id":43,"method":"test/add","params":{"a":1,"b":2}})",
+        R"({"jsonrpc":"2.0","id":44,"method":"test/add","params":{"a":3,"b":4}})",
+        R"({"jsonrpc":"2.0","id":45,"method":"test/add","params":{"a":5,"b":6}})",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    peer.set_worker_threads(1);
+
+    std::atomic<bool> release = false;
+    std::atomic<int> active = 0;
+    std::atomic<int> peak = 0;
+    peer.on_worker_request(
+        [&](const AddParams& params, const cancellation_token&) -> Result<AddResult> {
+            auto now = active.fetch_add(1) + 1;
+            auto seen = peak.load();
+            while(now > seen && !peak.compare_exchange_weak(seen, now)) {}
+            while(!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            active.fetch_sub(1);
+            return AddResult{.sum = params.a + params.b};
+        });
+
+    // The handlers block until libuv's shared pool has run something, which only works if
+    // they are not occupying it.
+    auto releaser = [&]() -> task<> {
+        auto ran = co_await queue([] {}, loop);
+        EXPECT_FALSE(ran.has_error());
+        release = true;
+    };
+
+    auto release_task = releaser();
+    loop.schedule(peer.run());
+    loop.schedule(release_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_EQ(peak.load(), 1);
+    EXPECT_EQ(transport_ptr->outgoing().size(), 3U);
+}
+
+TEST_CASE(supersede_queued_notifications) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"b"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"c"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+    });
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<std::string> seen;
+    peer.on_notification([&](const NoteParams& params) { seen.push_back(params.text); });
+    peer.supersede_queued<NoteParams>(
+        [](const NoteParams& params) -> std::optional<std::string> { return params.text; });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    // The transport delivers everything in one burst; only the last "a" survives, and the
+    // survivors keep their arrival order.
+    ASSERT_EQ(seen.size(), 3U);
+    EXPECT_EQ(seen[0], "b");
+    EXPECT_EQ(seen[1], "c");
+    EXPECT_EQ(seen[2], "a");
+}
+
+TEST_CASE(supersede_queued_requests) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","id":51,"method":"test/add","params":{"a":1,"b":1}})",
+        R"({"jsonrpc":"2.0","id":52,"method":"test/add","params":{"a":2,"b":2}})",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    int calls = 0;
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        ++calls;
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.supersede_queued<AddParams>(
+        [](const AddParams&) -> std::optional<std::string> { return "add"; });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_EQ(calls, 1);
+    ASSERT_EQ(transport_ptr->outgoing().size(), 2U);
+
+    auto superseded = codec::json::from_json<ErrorResponse>(transport_ptr->outgoing()[0]);
+    ASSERT_TRUE(superseded.has_value());
+    EXPECT_EQ(std::get<std::int64_t>(superseded->id), 51);
+    EXPECT_EQ(superseded->error.code,
+              static_cast<protocol::integer>(protocol::ErrorCode::RequestCancelled));
+
+    auto response = codec::json::from_json<Response>(transport_ptr->outgoing()[1]);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(std::get<std::int64_t>(response->id), 52);
+    ASSERT_TRUE(response->result.has_value());
+    EXPECT_EQ(response->result->sum, 4);
+}
+
+TEST_CASE(supersede_queued_unkeyed_in_order) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+        R"({"jsonrpc":"2.0","id":53,"method":"test/add","params":{"a":1,"b":2}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+    });
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<std::string> seen;
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        seen.emplace_back("request");
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.on_notification([&](const NoteParams& params) { seen.push_back(params.text); });
+    peer.supersede_queued<NoteParams>(
+        [](const NoteParams& params) -> std::optional<std::string> { return params.text; });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    // The request has no rule: it runs right away, after the note queued before it, which it
+    // therefore keeps from being superseded.
+    ASSERT_EQ(seen.size(), 3U);
+    EXPECT_EQ(seen[0], "a");
+    EXPECT_EQ(seen[1], "request");
+    EXPECT_EQ(seen[2], "a");
+}
+
+TEST_CASE(coalesce_queued_notifications) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a1"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"b1"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a2"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a3"}})",
+    });
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    std::vector<std::string> seen;
+    peer.on_notification([&](const NoteParams& params) { seen.push_back(params.text); });
+    peer.coalesce_queued<NoteParams>(
+        [](const NoteParams& params) -> std::optional<std::string> {
+            return params.text.substr(0, 1);
+        },
+        [](NoteParams& older, const NoteParams& newer) { older.text += "+" + newer.text; });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(seen.size(), 2U);
+    EXPECT_EQ(seen[0], "b1");
+    EXPECT_EQ(seen[1], "a1+a2+a3");
+}
+
+TEST_CASE(supersede_queued_close_from_handler) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"a"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"exit"}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"b"}})",
+    });
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    // Like an LSP `exit` handler: closing clears the queue the handler was dispatched from.
+    std::vector<std::string> seen;
+    peer.on_notification([&](const NoteParams& params) {
+        seen.push_back(params.text);
+        if(params.text == "exit") {
+            peer.close();
+        }
+    });
+    peer.supersede_queued<NoteParams>(
+        [](const NoteParams& params) -> std::optional<std::string> { return params.text; });
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_EQ(seen.size(), 2U);
+    EXPECT_EQ(seen[0], "a");
+    EXPECT_EQ(seen[1], "exit");
+}
+
+TEST_CASE(outgoing_limits_drop_notifications) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    peer.set_outgoing_limits(outgoing_queue_limits{
+        .max_messages = 1,
+        .droppable = [](std::string_view method) { return method == "test/note"; },
+    });
+
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "kept"}).has_value());
+    const auto queued = peer.outgoing_queue_bytes();
+    EXPECT_GT(queued, 0U);
+
+    // The queue is full: the droppable notification is discarded, the other one still queues.
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "dropped"}).has_value());
+    ASSERT_TRUE(peer.send_notification("test/other", NoteParams{.text = "forced"}).has_value());
+    EXPECT_EQ(peer.dropped_notifications(), 1U);
+    EXPECT_GT(peer.outgoing_queue_bytes(), queued);
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_EQ(peer.outgoing_queue_bytes(), 0U);
+    ASSERT_EQ(transport_ptr->outgoing().size(), 2U);
+    auto first = codec::json::from_json<Notification>(transport_ptr->outgoing()[0]);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->params.text, "kept");
+}
+
+TEST_CASE(outgoing_limits_wait_for_space) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    peer.set_outgoing_limits(outgoing_queue_limits{.max_bytes = 1});
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "fill"}).has_value());
+
+    bool resumed = false;
+    std::size_t bytes_on_resume = 0;
+    auto sender = [&]() -> task<> {
+        co_await peer.wait_for_outgoing_space();
+        resumed = true;
+        bytes_on_resume = peer.outgoing_queue_bytes();
+    };
+
+    auto sender_task = sender();
+    loop.schedule(sender_task);
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    EXPECT_TRUE(resumed);
+    EXPECT_EQ(bytes_on_resume, 0U);
+}
+
+TEST_CASE(outgoing_limits_wait_honours_timeout_and_token) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{});
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+
+    // The write loop never runs, so the queue stays full.
+    peer.set_outgoing_limits(outgoing_queue_limits{.max_bytes = 1});
+    ASSERT_TRUE(peer.send_notification(NoteParams{.text = "fill"}).has_value());
+    const auto queued = peer.outgoing_queue_bytes();
+
+    Result<AddResult> timed_result = outcome_error(Error("request did not complete"));
+    Result<AddResult> cancelled_result = outcome_error(Error("request did not complete"));
+    cancellation_source source;
+
+    auto timed = [&]() -> task<> {
+        timed_result =
+            co_await peer.send_request<AddResult>("worker/build",
+                                                  CustomAddParams{.a = 1, .b = 2},
+                                                  {.timeout = std::chrono::milliseconds{5}});
+    };
+    auto cancelled = [&]() -> task<> {
+        cancelled_result =
+            co_await peer.send_request<AddResult>("worker/build",
+                                                  CustomAddParams{.a = 3, .b = 4},
+                                                  {.token = source.token()});
+    };
+    auto canceller = [&]() -> task<> {
+        co_await sleep(1, loop);
+        source.cancel();
+    };
+
+    auto timed_task = timed();
+    auto cancelled_task = cancelled();
+    auto canceller_task = canceller();
+    loop.schedule(timed_task);
+    loop.schedule(cancelled_task);
+    loop.schedule(canceller_task);
+    EXPECT_EQ(loop.run(), 0);
+
+    ASSERT_FALSE(timed_result.has_value());
+    EXPECT_EQ(timed_result.error().code,
+              static_cast<protocol::integer>(protocol::ErrorCode::RequestCancelled));
+    EXPECT_EQ(timed_result.error().message, "request timed out");
+
+    ASSERT_FALSE(cancelled_result.has_value());
+    EXPECT_EQ(cancelled_result.error().code,
+              static_cast<protocol::integer>(protocol::ErrorCode::RequestCancelled));
+    EXPECT_EQ(cancelled_result.error().message, "request cancelled");
+
+    // Neither request was enqueued.
+    EXPECT_EQ(peer.outgoing_queue_bytes(), queued);
+}
+
+TEST_CASE(metrics_snapshot_counts) {
+    auto transport = std::make_unique<FakeTransport>(std::vector<std::string>{
+        R"({"jsonrpc":"2.0","id":61,"method":"test/add","params":{"a":1,"b":2}})",
+        R"({"jsonrpc":"2.0","id":62,"method":"test/add","params":{"a":3,"b":4}})",
+        R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"hi"}})",
+        R"({"jsonrpc":"2.0","method":"test/unknown","params":{}})",
+    });
+    auto* transport_ptr = transport.get();
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    peer.enable_metrics();
+
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.on_notification([&](const NoteParams&) {});
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    auto snapshot = peer.metrics_snapshot();
+    ASSERT_EQ(snapshot.size(), 2U);
+
+    const auto& add = snapshot[0];
+    EXPECT_EQ(add.method, "test/add");
+    EXPECT_EQ(add.requests, 2U);
+    EXPECT_EQ(add.in_flight, 0U);
+    EXPECT_EQ(add.cancelled, 0U);
+    EXPECT_EQ(add.failed, 0U);
+    EXPECT_EQ(add.handler_latency.count(), 2U);
+    EXPECT_EQ(add.queue_wait.count(), 2U);
+    EXPECT_GT(add.bytes_in, 0U);
+
+    std::uint64_t written = 0;
+    for(const auto& message: transport_ptr->outgoing()) {
+        written += message.size();
+    }
+    EXPECT_EQ(add.bytes_out, written);
+
+    const auto& note = snapshot[1];
+    EXPECT_EQ(note.method, "test/note");
+    EXPECT_EQ(note.notifications, 1U);
+    EXPECT_EQ(note.requests, 0U);
+    EXPECT_EQ(note.handler_latency.count(), 1U);
+}
+
+TEST_CASE(metrics_batch_counts_element_bytes) {
+    const std::string first =
+        R"({"jsonrpc":"2.0","id":71,"method":"test/add","params":{"a":1,"b":2}})";
+    const std::string second =
+        R"({"jsonrpc":"2.0","id":72,"method":"test/add","params":{"a":3,"b":4}})";
+    const std::string note = R"({"jsonrpc":"2.0","method":"test/note","params":{"text":"hi"}})";
+    auto transport = std::make_unique<FakeTransport>(
+        std::vector<std::string>{"[" + first + "," + second + "," + note + "]"});
+
+    event_loop loop;
+    JsonPeer peer(loop, std::move(transport));
+    peer.enable_metrics();
+
+    peer.on_request([&](RequestContext&, const AddParams& params) -> RequestResult<AddParams> {
+        co_return AddResult{.sum = params.a + params.b};
+    });
+    peer.on_notification([&](const NoteParams&) {});
+
+    loop.schedule(peer.run());
+    EXPECT_EQ(loop.run(), 0);
+
+    // Every element shares the batch's buffer; each is charged only for its own text.
+    auto snapshot = peer.metrics_snapshot();
+    ASSERT_EQ(snapshot.size(), 2U);
+    EXPECT_EQ(snapshot[0].method, "test/add");
+    EXPECT_EQ(snapshot[0].requests, 2U);
+    EXPECT_EQ(snapshot[0].bytes_in, first.size() + second.size());
+    EXPECT_EQ(snapshot[1].method, "test/note");
+    EXPECT_EQ(snapshot[1].notifications, 1U);
+    EXPECT_EQ(snapshot[1].bytes_in, note.size());
+}
+
 };  // TEST_SUITE(ipc_peer)
 
 // ============================================================================
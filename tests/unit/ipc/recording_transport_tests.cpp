@@ -0,0 +1,93 @@
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_transport.h"
+#include "kota/zest/zest.h"
+#include "kota/async/async.h"
+#include "kota/ipc/recording_transport.h"
+
+namespace kota::ipc {
+
+namespace {
+
+std::string temp_trace_path(std::string_view name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Reads every message through `transport`, then closes it so the trace is complete. The fake
+// inner transport does not support close(), so the error it reports is ignored.
+void read_all(RecordingTransport& transport) {
+    event_loop loop;
+    auto reader = [&]() -> task<> {
+        while(co_await transport.read_message()) {}
+    };
+
+    auto reader_task = reader();
+    loop.schedule(reader_task);
+    loop.run();
+    (void)transport.close();
+}
+
+std::vector<std::string> read_lines(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<std::string> lines;
+    for(std::string line; std::getline(file, line);) {
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+TEST_SUITE(ipc_recording_transport) {
+
+TEST_CASE(records_messages_to_file) {
+    const auto path = temp_trace_path("kotatsu-recording-basic.jsonl");
+    RecordingTransport transport(std::make_unique<FakeTransport>(std::vector<std::string>{
+                                     R"({"jsonrpc":"2.0","method":"a"})",
+                                     "{\"text\":\"x\\ny\"}",
+                                     "tab\there",
+                                 }),
+                                 path);
+    read_all(transport);
+
+    auto lines = read_lines(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(lines.size(), 3U);
+    EXPECT_TRUE(lines[0].starts_with(R"({"ts":)"));
+    EXPECT_TRUE(lines[0].ends_with(R"("msg":"{\"jsonrpc\":\"2.0\",\"method\":\"a\"}"})"));
+    EXPECT_TRUE(lines[1].ends_with(R"("msg":"{\"text\":\"x\\ny\"}"})"));
+    EXPECT_TRUE(lines[2].ends_with(R"("msg":"tab\there"})"));
+    EXPECT_EQ(transport.dropped_records(), 0U);
+}
+
+TEST_CASE(drops_records_over_cap) {
+    const auto path = temp_trace_path("kotatsu-recording-cap.jsonl");
+    // Larger than the whole buffer, so it is dropped however far the writer has got.
+    const std::string oversized(256, 'x');
+    RecordingTransport transport(std::make_unique<FakeTransport>(std::vector<std::string>{
+                                     "first",
+                                     oversized,
+                                     "last",
+                                 }),
+                                 path,
+                                 recording_options{.max_buffered_bytes = 64});
+    read_all(transport);
+
+    auto lines = read_lines(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(transport.dropped_records(), 1U);
+    ASSERT_EQ(lines.size(), 2U);
+    EXPECT_TRUE(lines[0].ends_with(R"("msg":"first"})"));
+    EXPECT_TRUE(lines[1].ends_with(R"("msg":"last"})"));
+}
+
+};  // TEST_SUITE(ipc_recording_transport)
+
+}  // namespace
+
+}  // namespace kota::ipc
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kota/ipc/replay_transport.h"
+#include "kota/zest/zest.h"
+#include "kota/async/async.h"
+
+namespace kota::ipc {
+
+namespace {
+
+TEST_SUITE(ipc_replay_transport) {
+
+TEST_CASE(replays_and_matches_responses) {
+    event_loop loop;
+
+    const std::vector<std::string_view> lines = {
+        R"({"ts":100,"msg":"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"a\",\"params\":{\"s\":\"x\\ny\"}}"})",
+        R"({"ts":105,"msg":"{\"jsonrpc\":\"2.0\",\"method\":\"note\"}"})",
+        "",
+        R"({"ts":110,"msg":"{\"jsonrpc\":\"2.0\",\"id\":\"b\",\"method\":\"b\"}"})",
+    };
+
+    const replay_options options{.speed = 0, .drain_timeout = std::chrono::milliseconds(20)};
+    auto replay = ReplayTransport::from_lines(lines, options, loop);
+    ASSERT_TRUE(replay.has_value());
+    auto& transport = **replay;
+    EXPECT_EQ(transport.size(), 3U);
+
+    // Answers every request except "b", echoing the id as a server would.
+    auto server = [&]() -> task<std::vector<std::string>> {
+        std::vector<std::string> seen;
+        while(auto message = co_await transport.read_message()) {
+            seen.emplace_back(message->view());
+            if(seen.size() == 1) {
+                auto written = co_await transport.write_message(
+                    R"({"jsonrpc":"2.0","id":1,"result":null})");
+                EXPECT_TRUE(written.has_value());
+            }
+        }
+        co_return seen;
+    };
+
+    auto server_task = server();
+    loop.schedule(server_task);
+    loop.run();
+
+    auto seen = server_task.result();
+    ASSERT_EQ(seen.size(), 3U);
+    EXPECT_EQ(seen[0], R"({"jsonrpc":"2.0","id":1,"method":"a","params":{"s":"x\ny"}})");
+    EXPECT_EQ(seen[1], R"({"jsonrpc":"2.0","method":"note"})");
+
+    const auto& stats = transport.stats();
+    EXPECT_EQ(stats.requests, 2U);
+    EXPECT_EQ(stats.notifications, 1U);
+    EXPECT_EQ(stats.responses, 1U);
+    EXPECT_EQ(stats.unanswered, 1U);
+    EXPECT_EQ(stats.latency.count(), 1U);
+}
+
+TEST_CASE(malformed_line) {
+    event_loop loop;
+
+    const std::vector<std::string_view> lines = {R"({"ts":1,"msg":"{}"})", R"({"ts":2})"};
+    auto replay = ReplayTransport::from_lines(lines, {}, loop);
+    EXPECT_FALSE(replay.has_value());
+}
+
+};  // TEST_SUITE(ipc_replay_transport)
+
+}  // namespace
+}  // namespace kota::ipc
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "kota/ipc/request_table.h"
+#include "kota/zest/zest.h"
+
+namespace kota::ipc {
+
+namespace {
+
+TEST_SUITE(ipc_request_table) {
+
+TEST_CASE(insert_find_erase) {
+    detail::request_table<int> table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_TRUE(table.find(1) == nullptr);
+
+    auto [first, first_value] = table.insert();
+    first_value = 10;
+    auto [second, second_value] = table.insert();
+    second_value = 20;
+
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(table.size(), 2U);
+    ASSERT_TRUE(table.find(first) != nullptr);
+    EXPECT_EQ(*table.find(first), 10);
+    ASSERT_TRUE(table.find(second) != nullptr);
+    EXPECT_EQ(*table.find(second), 20);
+    EXPECT_TRUE(table.find(0) == nullptr);
+    EXPECT_TRUE(table.find(-1) == nullptr);
+    EXPECT_TRUE(table.find(3) == nullptr);
+
+    table.erase(first);
+    EXPECT_TRUE(table.find(first) == nullptr);
+    EXPECT_EQ(table.size(), 1U);
+
+    // Erasing twice, or an id never issued, is a no-op.
+    table.erase(first);
+    table.erase(99);
+    EXPECT_EQ(table.size(), 1U);
+}
+
+TEST_CASE(stale_id_misses_reused_slot) {
+    detail::request_table<int> table;
+    const auto capacity = [&] {
+        auto [id, value] = table.insert();
+        table.erase(id);
+        return table.capacity();
+    }();
+
+    // After a full lap the next id maps to the first id's slot again.
+    std::int64_t last = 0;
+    for(std::size_t i = 0; i < capacity; ++i) {
+        auto [id, value] = table.insert();
+        table.erase(id);
+        last = id;
+    }
+    auto [id, value] = table.insert();
+    EXPECT_EQ(id, last + 1);
+    EXPECT_EQ(table.capacity(), capacity);
+    EXPECT_TRUE(table.find(id - static_cast<std::int64_t>(capacity)) == nullptr);
+    EXPECT_TRUE(table.find(id) != nullptr);
+}
+
+TEST_CASE(grows_with_outstanding) {
+    detail::request_table<std::int64_t> table;
+    std::vector<std::int64_t> ids;
+    for(int i = 0; i < 100; ++i) {
+        auto [id, value] = table.insert();
+        value = id * 2;
+        ids.push_back(id);
+    }
+
+    EXPECT_EQ(table.size(), 100U);
+    EXPECT_TRUE(table.capacity() >= 100U);
+    for(auto id: ids) {
+        ASSERT_TRUE(table.find(id) != nullptr);
+        EXPECT_EQ(*table.find(id), id * 2);
+    }
+
+    auto listed = table.ids();
+    std::ranges::sort(listed);
+    EXPECT_EQ(listed, ids);
+}
+
+TEST_CASE(straggler_moves_to_overflow) {
+    detail::request_table<int> table;
+    auto [stuck, stuck_value] = table.insert();
+    stuck_value = 7;
+
+    // Many short-lived requests after one that never completes do not grow the array.
+    for(int i = 0; i < 10000; ++i) {
+        auto [id, value] = table.insert();
+        table.erase(id);
+    }
+
+    EXPECT_TRUE(table.capacity() <= 64U);
+    EXPECT_EQ(table.size(), 1U);
+    ASSERT_TRUE(table.find(stuck) != nullptr);
+    EXPECT_EQ(*table.find(stuck), 7);
+
+    table.erase(stuck);
+    EXPECT_TRUE(table.empty());
+    EXPECT_TRUE(table.find(stuck) == nullptr);
+}
+
+};  // TEST_SUITE(ipc_request_table)
+
+}  // namespace
+
+}  // namespace kota::ipc
@@ -0,0 +1,299 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "kota/ipc/shm_transport.h"
+#include "kota/zest/zest.h"
+#include "kota/async/async.h"
+
+#ifndef _WIN32
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace kota::ipc {
+
+namespace {
+
+// Set in the environment of the copy of this binary that `spawn_round_trip` starts.
+constexpr const char* echo_child_env = "KOTA_SHM_ECHO_CHILD";
+
+struct linked_pair {
+    std::unique_ptr<SharedMemoryTransport> first;
+    std::unique_ptr<SharedMemoryTransport> second;
+};
+
+std::optional<linked_pair> make_link(event_loop& loop, std::size_t ring_bytes) {
+    auto created = SharedMemoryTransport::create(loop, ring_bytes);
+    if(!created) {
+        return std::nullopt;
+    }
+    auto opened = SharedMemoryTransport::open(created->second, loop);
+    if(!opened) {
+        return std::nullopt;
+    }
+    return linked_pair{std::move(created->first), std::move(*opened)};
+}
+
+// Read until end of input, then close so the loop can finish.
+task<std::vector<std::string>> read_all(Transport& transport) {
+    std::vector<std::string> results;
+    while(auto message = co_await transport.read_message()) {
+        results.emplace_back(message->view());
+    }
+    transport.close();
+    co_return results;
+}
+
+TEST_SUITE(ipc_shm_transport) {
+
+TEST_CASE(both_directions) {
+    event_loop loop;
+
+    auto link = make_link(loop, SharedMemoryTransport::default_ring_bytes);
+    ASSERT_TRUE(link.has_value());
+
+    auto send = [](SharedMemoryTransport& transport,
+                   std::vector<std::string> payloads) -> task<> {
+        for(auto& payload: payloads) {
+            auto written = co_await transport.write_message(payload);
+            EXPECT_TRUE(written.has_value());
+        }
+        EXPECT_TRUE(transport.close_output().has_value());
+    };
+
+    auto forward = send(*link->first, {"ping", "", R"({"jsonrpc":"2.0","method":"x"})"});
+    auto backward = send(*link->second, {"pong"});
+    auto read_second = read_all(*link->second);
+    auto read_first = read_all(*link->first);
+    loop.schedule(forward);
+    loop.schedule(backward);
+    loop.schedule(read_second);
+    loop.schedule(read_first);
+    loop.run();
+
+    auto at_second = read_second.result();
+    ASSERT_EQ(at_second.size(), 3U);
+    EXPECT_EQ(at_second[0], "ping");
+    EXPECT_TRUE(at_second[1].empty());
+    EXPECT_EQ(at_second[2], R"({"jsonrpc":"2.0","method":"x"})");
+
+    auto at_first = read_first.result();
+    ASSERT_EQ(at_first.size(), 1U);
+    EXPECT_EQ(at_first[0], "pong");
+}
+
+TEST_CASE(message_larger_than_ring) {
+    event_loop loop;
+
+    auto link = make_link(loop, 4096);
+    ASSERT_TRUE(link.has_value());
+
+    std::string large(100 * 1024, '\0');
+    for(std::size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+
+    auto writer = [&]() -> task<> {
+        auto first = co_await link->first->write_message(large);
+        EXPECT_TRUE(first.has_value());
+        auto second = co_await link->first->write_message("tail");
+        EXPECT_TRUE(second.has_value());
+        EXPECT_TRUE(link->first->close_output().has_value());
+        link->first->close();
+    };
+
+    auto write_task = writer();
+    auto read_task = read_all(*link->second);
+    loop.schedule(write_task);
+    loop.schedule(read_task);
+    loop.run();
+
+    auto results = read_task.result();
+    ASSERT_EQ(results.size(), 2U);
+    EXPECT_TRUE(results[0] == large);
+    EXPECT_EQ(results[1], "tail");
+}
+
+TEST_CASE(peer_close_ends_input) {
+    event_loop loop;
+
+    auto link = make_link(loop, SharedMemoryTransport::default_ring_bytes);
+    ASSERT_TRUE(link.has_value());
+
+    // Dropping the other side without close_output() is what a crashed peer looks like.
+    auto reader = [&]() -> task<std::optional<std::string>> {
+        auto message = co_await link->second->read_message();
+        link->second->close();
+        if(!message) {
+            co_return std::nullopt;
+        }
+        co_return std::string(message->view());
+    };
+
+    auto dropper = [&]() -> task<> {
+        link->first.reset();
+        co_return;
+    };
+
+    auto read_task = reader();
+    auto drop_task = dropper();
+    loop.schedule(read_task);
+    loop.schedule(drop_task);
+    loop.run();
+
+    EXPECT_FALSE(read_task.result().has_value());
+}
+
+TEST_CASE(corrupt_counters_close_transport) {
+    event_loop loop;
+
+    auto created = SharedMemoryTransport::create(loop, 4096);
+    ASSERT_TRUE(created.has_value());
+    // open() closes the descriptor it is given; keep one to map the region ourselves.
+    const int memory_fd = ::dup(created->second.memory_fd);
+    ASSERT_TRUE(memory_fd >= 0);
+    auto opened = SharedMemoryTransport::open(created->second, loop);
+    ASSERT_TRUE(opened.has_value());
+
+    struct stat info {};
+    ASSERT_EQ(::fstat(memory_fd, &info), 0);
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    ::close(memory_fd);
+    ASSERT_TRUE(mapping != MAP_FAILED);
+
+    // The region header fills the first cache line; the creator's outgoing ring control
+    // follows, with `head` and `tail` on the next two lines.
+    auto* base = static_cast<std::byte*>(mapping);
+    auto& head = *reinterpret_cast<std::atomic<std::uint64_t>*>(base + 64);
+    auto& tail = *reinterpret_cast<std::atomic<std::uint64_t>*>(base + 128);
+
+    auto& writer = *created->first;
+    auto& reader = **opened;
+    auto run = [&]() -> task<> {
+        auto written = co_await writer.write_message("ping");
+        EXPECT_TRUE(written.has_value());
+        auto message = co_await reader.read_message();
+        EXPECT_TRUE(message.has_value());
+
+        // A head more than a ring ahead of the reader would have it copy past the mapping.
+        head.store(head.load() + 3 * 4096);
+        message = co_await reader.read_message();
+        EXPECT_FALSE(message.has_value());
+        auto reply = co_await reader.write_message("pong");
+        EXPECT_FALSE(reply.has_value());
+
+        // A tail ahead of the writer's head would make the free space underflow.
+        tail.store(head.load() + 1);
+        written = co_await writer.write_message("ping");
+        EXPECT_FALSE(written.has_value());
+    };
+
+    auto run_task = run();
+    loop.schedule(run_task);
+    loop.run();
+    ::munmap(mapping, size);
+}
+
+// Body of the child started by `spawn_round_trip`; a no-op in a normal test run. Echoes every
+// message back over the link inherited as fds 3 and 4.
+TEST_CASE(spawned_echo_child) {
+    if(std::getenv(echo_child_env) == nullptr) {
+        zest::skip();
+        return;
+    }
+
+    event_loop loop;
+    auto transport = SharedMemoryTransport::open_inherited(loop);
+    ASSERT_TRUE(transport.has_value());
+
+    auto echo = [&]() -> task<> {
+        while(auto message = co_await (*transport)->read_message()) {
+            auto written = co_await (*transport)->write_message(message->view());
+            if(!written) {
+                break;
+            }
+        }
+        (*transport)->close();
+    };
+
+    auto echo_task = echo();
+    loop.schedule(echo_task);
+    loop.run();
+}
+
+TEST_CASE(spawn_round_trip) {
+#ifndef __linux__
+    // Re-running the test binary relies on /proc/self/exe.
+    zest::skip();
+    return;
+#else
+    if(std::getenv(echo_child_env) != nullptr) {
+        zest::skip();
+        return;
+    }
+
+    event_loop loop;
+
+    // Re-run this binary with only the echo case selected.
+    process::options opts;
+    opts.file = "/proc/self/exe";
+    opts.args = {opts.file, "ipc_shm_transport.spawned_echo_child"};
+    for(char** entry = environ; *entry != nullptr; ++entry) {
+        opts.env.emplace_back(*entry);
+    }
+    opts.env.emplace_back(std::string(echo_child_env) + "=1");
+    opts.streams = {process::stdio::ignore(), process::stdio::ignore(), process::stdio::ignore()};
+
+    auto spawned = SharedMemoryTransport::spawn(opts, loop, 4096);
+    ASSERT_TRUE(spawned.has_value());
+    auto& [child, transport] = *spawned;
+
+    std::string large(20 * 1024, '\0');
+    for(std::size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+    const std::vector<std::string> payloads = {"ping", large, "", "tail"};
+
+    auto writer = [&]() -> task<> {
+        for(auto& payload: payloads) {
+            auto written = co_await transport->write_message(payload);
+            EXPECT_TRUE(written.has_value());
+        }
+        EXPECT_TRUE(transport->close_output().has_value());
+    };
+
+    auto waiter = [&]() -> task<process::wait_result> {
+        co_return co_await child.proc.wait();
+    };
+
+    auto write_task = writer();
+    auto read_task = read_all(*transport);
+    auto wait_task = waiter();
+    loop.schedule(write_task);
+    loop.schedule(read_task);
+    loop.schedule(wait_task);
+    loop.run();
+
+    EXPECT_TRUE(read_task.result() == payloads);
+    auto status = wait_task.result();
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(status->status, 0);
+    EXPECT_EQ(status->term_signal, 0);
+#endif
+}
+
+};  // TEST_SUITE(ipc_shm_transport)
+
+}  // namespace
+}  // namespace kota::ipc
+
+#endif
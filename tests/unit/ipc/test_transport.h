@@ -17,11 +17,11 @@ public:
     explicit FakeTransport(std::vector<std::string> incoming) :
         incoming_messages(std::move(incoming)) {}
 
-    task<std::optional<std::string>> read_message() override {
+    task<std::optional<MessageBuffer>> read_message() override {
         if(read_index >= incoming_messages.size()) {
             co_return std::nullopt;
         }
-        co_return incoming_messages[read_index++];
+        co_return MessageBuffer(incoming_messages[read_index++]);
     }
 
     task<void, Error> write_message(std::string_view payload) override {
@@ -50,7 +50,7 @@ public:
         }
     }
 
-    task<std::optional<std::string>> read_message() override {
+    task<std::optional<MessageBuffer>> read_message() override {
         if(closed) {
             co_return std::nullopt;
         }
@@ -64,7 +64,7 @@ public:
             readable.reset();
         }
 
-        co_return incoming_messages[read_index++];
+        co_return MessageBuffer(incoming_messages[read_index++]);
     }
 
     task<void, Error> write_message(std::string_view payload) override {
@@ -1,10 +1,15 @@
 #include <atomic>
+#include <chrono>
 #include <optional>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
+
 #include "test_transport.h"
 #include "../support/fd_helpers.h"
 #include "kota/ipc/transport.h"
@@ -15,14 +20,23 @@ namespace kota::ipc {
 
 using test::create_pipe;
 using test::close_fd;
+using test::read_fd;
 using test::write_fd;
 
 namespace {
 
+task<std::optional<std::string>> read_text(Transport& transport) {
+    auto message = co_await transport.read_message();
+    if(!message) {
+        co_return std::nullopt;
+    }
+    co_return std::string(message->view());
+}
+
 task<std::pair<std::optional<std::string>, std::optional<std::string>>>
-    read_two_messages(StreamTransport& transport) {
-    auto first = co_await transport.read_message();
-    auto second = co_await transport.read_message();
+    read_two_messages(Transport& transport) {
+    auto first = co_await read_text(transport);
+    auto second = co_await read_text(transport);
     event_loop::current().stop();
     co_return std::pair{std::move(first), std::move(second)};
 }
@@ -77,7 +91,7 @@ TEST_CASE(empty_payload) {
     ASSERT_EQ(close_fd(fds[1]), 0);
 
     auto reader = [&]() -> task<std::optional<std::string>> {
-        co_return co_await transport.read_message();
+        co_return co_await read_text(transport);
     };
 
     auto read_task = reader();
@@ -116,7 +130,7 @@ TEST_CASE(header_too_large) {
     });
 
     auto reader = [&]() -> task<std::optional<std::string>> {
-        co_return co_await transport.read_message();
+        co_return co_await read_text(transport);
     };
 
     auto read_task = reader();
@@ -148,7 +162,7 @@ TEST_CASE(incomplete_header) {
     ASSERT_EQ(close_fd(fds[1]), 0);
 
     auto reader = [&]() -> task<std::optional<std::string>> {
-        co_return co_await transport.read_message();
+        co_return co_await read_text(transport);
     };
 
     auto read_task = reader();
@@ -177,7 +191,7 @@ TEST_CASE(length_mismatch) {
     ASSERT_EQ(close_fd(fds[1]), 0);
 
     auto reader = [&]() -> task<std::optional<std::string>> {
-        co_return co_await transport.read_message();
+        co_return co_await read_text(transport);
     };
 
     auto read_task = reader();
@@ -213,7 +227,7 @@ TEST_CASE(rapid_sequential) {
     auto reader = [&]() -> task<std::vector<std::string>> {
         std::vector<std::string> results;
         for(int i = 0; i < count; ++i) {
-            auto msg = co_await transport.read_message();
+            auto msg = co_await read_text(transport);
             if(!msg)
                 break;
             results.push_back(std::move(*msg));
@@ -259,7 +273,7 @@ TEST_CASE(large_payload_single_chunk) {
     });
 
     auto reader = [&]() -> task<std::optional<std::string>> {
-        co_return co_await transport.read_message();
+        co_return co_await read_text(transport);
     };
 
     auto read_task = reader();
@@ -273,6 +287,360 @@ TEST_CASE(large_payload_single_chunk) {
     EXPECT_EQ(result->size(), payload.size());
 }
 
+// read_message() returns the body followed by zeroed padding for in-place parsing.
+TEST_CASE(message_buffer_padded) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+
+    StreamTransport transport(stream(std::move(*input)));
+
+    const std::string payload = R"({"jsonrpc":"2.0","method":"padded"})";
+    const auto data = frame(payload);
+    ASSERT_EQ(write_fd(fds[1], data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    ASSERT_EQ(close_fd(fds[1]), 0);
+
+    auto reader = [&]() -> task<std::optional<MessageBuffer>> {
+        co_return co_await transport.read_message();
+    };
+
+    auto read_task = reader();
+    loop.schedule(read_task);
+    loop.run();
+
+    auto result = read_task.result();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->view(), payload);
+    for(std::size_t i = 0; i < MessageBuffer::padding; ++i) {
+        EXPECT_EQ(result->data()[result->size() + i], '\0');
+    }
+}
+
+// A body larger than the stream's read buffer is gathered across reads, and a header split
+// across writes is still recognized.
+TEST_CASE(body_spans_chunks) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+
+    StreamTransport transport(stream(std::move(*input)));
+
+    std::string payload(200 * 1024, 'x');
+    payload.front() = '[';
+    payload.back() = ']';
+    std::string data = frame(payload) + frame("tail");
+
+    std::thread writer([&] {
+        const auto split = std::string_view("Content-Length: 20").size();
+        EXPECT_EQ(write_fd(fds[1], data.data(), split), static_cast<ssize_t>(split));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        EXPECT_EQ(write_fd(fds[1], data.data() + split, data.size() - split),
+                  static_cast<ssize_t>(data.size() - split));
+        EXPECT_EQ(close_fd(fds[1]), 0);
+    });
+
+    auto reader = [&]() -> task<std::pair<std::optional<std::string>, std::optional<std::string>>> {
+        auto first = co_await read_text(transport);
+        auto second = co_await read_text(transport);
+        co_return std::pair{std::move(first), std::move(second)};
+    };
+
+    auto read_task = reader();
+    loop.schedule(read_task);
+    loop.run();
+
+    writer.join();
+
+    auto [first, second] = read_task.result();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(first->size(), payload.size());
+    EXPECT_TRUE(*first == payload);
+    EXPECT_EQ(*second, "tail");
+}
+
+// Varint prefixes: 130 needs two bytes, 3 needs one.
+TEST_CASE(binary_varint_messages) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+
+    BinaryTransport transport(stream(std::move(*input)));
+
+    const std::string first_payload(130, 'b');
+    const std::string second_payload = "abc";
+    std::string data = "\x82\x01" + first_payload + "\x03" + second_payload;
+
+    ASSERT_EQ(write_fd(fds[1], data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    ASSERT_EQ(close_fd(fds[1]), 0);
+
+    auto reader = read_two_messages(transport);
+    loop.schedule(reader);
+    loop.run();
+
+    const auto [first, second] = reader.result();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(*first, first_payload);
+    EXPECT_EQ(*second, second_payload);
+}
+
+// Fixed little-endian prefix followed by a type byte.
+TEST_CASE(binary_fixed_type_byte) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+
+    BinaryTransport transport(stream(std::move(*input)),
+                              binary_framing{
+                                  .prefix = binary_framing::length_prefix::fixed32,
+                                  .type_byte = true,
+                              });
+
+    const std::string data("\x02\x00\x00\x00\x07hi", 7);
+    ASSERT_EQ(write_fd(fds[1], data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    ASSERT_EQ(close_fd(fds[1]), 0);
+
+    auto reader = [&]() -> task<std::optional<std::string>> {
+        co_return co_await read_text(transport);
+    };
+
+    auto read_task = reader();
+    loop.schedule(read_task);
+    loop.run();
+
+    auto result = read_task.result();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, "hi");
+    EXPECT_EQ(transport.last_message_type(), 7U);
+}
+
+// A varint prefix longer than any allowed payload length ends the input.
+TEST_CASE(binary_varint_overlong) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+
+    BinaryTransport transport(stream(std::move(*input)));
+
+    const std::string data = "\xff\xff\xff\xff\xff\xff\x01x";
+    ASSERT_EQ(write_fd(fds[1], data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    ASSERT_EQ(close_fd(fds[1]), 0);
+
+    auto reader = [&]() -> task<std::optional<std::string>> {
+        co_return co_await read_text(transport);
+    };
+
+    auto read_task = reader();
+    loop.schedule(read_task);
+    loop.run();
+
+    EXPECT_FALSE(read_task.result().has_value());
+}
+
+// Frames written by one BinaryTransport read back through another.
+TEST_CASE(binary_write_read_roundtrip) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options{}, loop);
+    ASSERT_TRUE(input.has_value());
+    auto output = pipe::open(fds[1], pipe::options{}, loop);
+    ASSERT_TRUE(output.has_value());
+
+    const binary_framing framing{.type_byte = true};
+    BinaryTransport reader_transport(stream(std::move(*input)), framing);
+    BinaryTransport writer_transport(stream(std::move(*output)), framing);
+
+    const std::vector<std::string> batch = {std::string(300, 'z'), ""};
+
+    auto writer = [&]() -> task<> {
+        auto first = co_await writer_transport.write_message("typed", 9);
+        EXPECT_TRUE(first.has_value());
+        auto rest = co_await writer_transport.write_messages(batch);
+        EXPECT_TRUE(rest.has_value());
+        EXPECT_TRUE(writer_transport.close_output().has_value());
+    };
+
+    auto reader = [&]() -> task<std::vector<std::pair<std::string, std::uint8_t>>> {
+        std::vector<std::pair<std::string, std::uint8_t>> results;
+        while(auto message = co_await reader_transport.read_message()) {
+            results.emplace_back(std::string(message->view()),
+                                 reader_transport.last_message_type());
+        }
+        co_return results;
+    };
+
+    auto write_task = writer();
+    auto read_task = reader();
+    loop.schedule(write_task);
+    loop.schedule(read_task);
+    loop.run();
+
+    auto results = read_task.result();
+    ASSERT_EQ(results.size(), 3U);
+    EXPECT_EQ(results[0].first, "typed");
+    EXPECT_EQ(results[0].second, 9U);
+    EXPECT_EQ(results[1].first, batch[0]);
+    EXPECT_EQ(results[1].second, 0U);
+    EXPECT_TRUE(results[2].first.empty());
+}
+
+TEST_CASE(binary_write_too_large) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(create_pipe(fds), 0);
+
+    auto output = pipe::open(fds[1], pipe::options{}, loop);
+    ASSERT_TRUE(output.has_value());
+
+    BinaryTransport transport(stream(std::move(*output)));
+
+    // One byte over the 64 MiB limit the reader enforces.
+    const std::vector<std::string> oversized = {"ok", std::string(64 * 1024 * 1024 + 1, 'x')};
+
+    auto writer = [&]() -> task<> {
+        auto single = co_await transport.write_message(oversized[1]);
+        EXPECT_FALSE(single.has_value());
+        auto batch = co_await transport.write_messages(oversized);
+        EXPECT_FALSE(batch.has_value());
+        EXPECT_TRUE(transport.close_output().has_value());
+    };
+
+    auto write_task = writer();
+    loop.schedule(write_task);
+    loop.run();
+
+    // Neither call wrote anything, not even the small message ahead of the oversized one.
+    char byte = 0;
+    EXPECT_EQ(read_fd(fds[0], &byte, 1), 0);
+    ASSERT_EQ(close_fd(fds[0]), 0);
+}
+
+#if defined(__linux__)
+TEST_CASE(attachment_roundtrip) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto input = pipe::open(fds[0], pipe::options(true), loop);
+    ASSERT_TRUE(input.has_value());
+    auto output = pipe::open(fds[1], pipe::options(true), loop);
+    ASSERT_TRUE(output.has_value());
+
+    StreamTransport reader_transport(stream(std::move(*input)));
+    StreamTransport writer_transport(stream(std::move(*output)));
+    writer_transport.set_attachment_threshold(64 * 1024);
+
+    std::string large(300 * 1024, '\0');
+    for(std::size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+    const std::vector<std::string> batch = {"before", large, "after"};
+
+    auto writer = [&]() -> task<> {
+        auto written = co_await writer_transport.write_messages(batch);
+        EXPECT_TRUE(written.has_value());
+        auto again = co_await writer_transport.write_message(large);
+        EXPECT_TRUE(again.has_value());
+        EXPECT_TRUE(writer_transport.close_output().has_value());
+    };
+
+    auto reader = [&]() -> task<std::vector<std::string>> {
+        std::vector<std::string> results;
+        while(auto message = co_await reader_transport.read_message()) {
+            results.emplace_back(message->view());
+        }
+        co_return results;
+    };
+
+    auto write_task = writer();
+    auto read_task = reader();
+    loop.schedule(write_task);
+    loop.schedule(read_task);
+    loop.run();
+
+    auto results = read_task.result();
+    ASSERT_EQ(results.size(), 4U);
+    EXPECT_EQ(results[0], "before");
+    EXPECT_TRUE(results[1] == large);
+    EXPECT_EQ(results[2], "after");
+    EXPECT_TRUE(results[3] == large);
+}
+
+TEST_CASE(attachment_threshold_without_ipc) {
+    event_loop loop;
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // Neither end can carry descriptors, so large payloads have to go inline.
+    auto input = pipe::open(fds[0], pipe::options(), loop);
+    ASSERT_TRUE(input.has_value());
+    auto output = pipe::open(fds[1], pipe::options(), loop);
+    ASSERT_TRUE(output.has_value());
+
+    StreamTransport reader_transport(stream(std::move(*input)));
+    StreamTransport writer_transport(stream(std::move(*output)));
+    writer_transport.set_attachment_threshold(16);
+
+    const std::string large(1024, 'x');
+    const std::vector<std::string> batch = {"before", large};
+
+    auto writer = [&]() -> task<> {
+        auto written = co_await writer_transport.write_message(large);
+        EXPECT_TRUE(written.has_value());
+        auto batched = co_await writer_transport.write_messages(batch);
+        EXPECT_TRUE(batched.has_value());
+        EXPECT_TRUE(writer_transport.close_output().has_value());
+    };
+
+    auto reader = [&]() -> task<std::vector<std::string>> {
+        std::vector<std::string> results;
+        while(auto message = co_await reader_transport.read_message()) {
+            results.emplace_back(message->view());
+        }
+        co_return results;
+    };
+
+    auto write_task = writer();
+    auto read_task = reader();
+    loop.schedule(write_task);
+    loop.schedule(read_task);
+    loop.run();
+
+    auto results = read_task.result();
+    ASSERT_EQ(results.size(), 3U);
+    EXPECT_TRUE(results[0] == large);
+    EXPECT_EQ(results[1], "before");
+    EXPECT_TRUE(results[2] == large);
+}
+#endif
+
 };  // TEST_SUITE(ipc_transport)
 
 }  // namespace
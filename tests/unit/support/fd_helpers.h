@@ -29,6 +29,10 @@ inline int close_fd(int fd) {
 inline ssize_t write_fd(int fd, const char* data, size_t len) {
     return _write(fd, data, static_cast<unsigned int>(len));
 }
+
+inline ssize_t read_fd(int fd, char* data, size_t len) {
+    return _read(fd, data, static_cast<unsigned int>(len));
+}
 #else
 inline int create_pipe(int fds[2]) {
     return ::pipe(fds);
@@ -41,6 +45,10 @@ inline int close_fd(int fd) {
 inline ssize_t write_fd(int fd, const char* data, size_t len) {
     return ::write(fd, data, len);
 }
+
+inline ssize_t read_fd(int fd, char* data, size_t len) {
+    return ::read(fd, data, len);
+}
 #endif
 
 }  // namespace kota::test